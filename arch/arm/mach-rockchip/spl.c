@@ -173,7 +173,9 @@ void board_init_f(ulong dummy)
 	}
 #if !defined(CONFIG_SUPPORT_TPL)
 	debug("\nspl:init dram\n");
+	bootstage_start(BOOTSTAGE_ID_ACCUM_DRAM, "dram");
 	ret = uclass_get_device(UCLASS_RAM, 0, &dev);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_DRAM);
 	if (ret) {
 		printf("DRAM init failed: %d\n", ret);
 		return;
@@ -114,14 +114,86 @@ __weak void rockchip_stimer_init(void)
 	writel(1, CONFIG_ROCKCHIP_STIMER_BASE + 0x10);
 }
 
+#ifdef CONFIG_ROCKCHIP_TPL_BOOTSTAGE
+/*
+ * The tiny framework has no bootstage core, so write the few records TPL
+ * has straight into the stash. SPL and U-Boot proper read them back with
+ * bootstage_unstash() and keep using the same arch timer, so the times
+ * line up with theirs.
+ */
+static const char tpl_bootstage_names[] = "reset\0tpl\0dram\0end_tpl";
+
+/* tpl_boot_us() divides by a constant, there is no 64-bit division here */
+#if COUNTER_FREQUENCY != 24000000
+#error "ROCKCHIP_TPL_BOOTSTAGE expects a 24MHz COUNTER_FREQUENCY"
+#endif
+
+static u32 tpl_boot_us(void)
+{
+	u64 count;
+#ifdef CONFIG_ARM64
+	asm volatile ("MRS %0, CNTPCT_EL0" : "=r"(count));
+#else
+	u32 nowl, nowu;
+
+	asm volatile("mrrc p15, 0, %0, %1, c14" : "=r" (nowl), "=r" (nowu));
+	count = (u64)nowu << 32 | nowl;
+#endif
+	/* count / 24 at 24MHz, the timer was reset on TPL entry */
+	return (u64)(u32)count * 0xaaaaaaabULL >> 36;
+}
+
+static void tpl_bootstage_stash(u32 tpl_us, u32 dram_us, u32 dram_end_us)
+{
+	struct bootstage_hdr *hdr = (void *)CONFIG_BOOTSTAGE_STASH_ADDR;
+	struct bootstage_stash_record *rec = (void *)(hdr + 1);
+	char *name = (char *)(rec + 4);
+	int i;
+
+	rec[0].id = BOOTSTAGE_ID_AWAKE;
+	rec[0].time_us = 0;
+	rec[0].start_us = 0;
+	rec[0].flags = 0;
+	rec[1].id = BOOTSTAGE_ID_START_TPL;
+	rec[1].time_us = tpl_us;
+	rec[1].start_us = 0;
+	rec[1].flags = 0;
+	rec[2].id = BOOTSTAGE_ID_ACCUM_DRAM;
+	rec[2].time_us = dram_end_us - dram_us;
+	rec[2].start_us = dram_us;
+	rec[2].flags = 0;
+	rec[3].id = BOOTSTAGE_ID_END_TPL;
+	rec[3].time_us = tpl_boot_us();
+	rec[3].start_us = 0;
+	rec[3].flags = 0;
+
+	/* No memcpy() in the tiny framework */
+	for (i = 0; i < sizeof(tpl_bootstage_names); i++)
+		name[i] = tpl_bootstage_names[i];
+
+	hdr->version = BOOTSTAGE_VERSION;
+	hdr->count = 4;
+	hdr->size = name + sizeof(tpl_bootstage_names) - (char *)hdr;
+	hdr->span_count = 0;
+	hdr->span_dropped = 0;
+	hdr->magic = BOOTSTAGE_MAGIC;
+}
+#endif
+
 void board_init_f(ulong dummy)
 {
 #if defined(CONFIG_SPL_FRAMEWORK) && !CONFIG_IS_ENABLED(TINY_FRAMEWORK)
 	struct udevice *dev;
 	int ret;
 #endif
+#ifdef CONFIG_ROCKCHIP_TPL_BOOTSTAGE
+	u32 tpl_us, dram_us;
+#endif
 
 	rockchip_stimer_init();
+#ifdef CONFIG_ROCKCHIP_TPL_BOOTSTAGE
+	tpl_us = tpl_boot_us();
+#endif
 #define EARLY_DEBUG
 #ifdef EARLY_DEBUG
 	/*
@@ -149,13 +221,28 @@ void board_init_f(ulong dummy)
 	timer_init();
 
 #if defined(CONFIG_SPL_FRAMEWORK) && !CONFIG_IS_ENABLED(TINY_FRAMEWORK)
+	bootstage_start(BOOTSTAGE_ID_ACCUM_DRAM, "dram");
 	ret = uclass_get_device(UCLASS_RAM, 0, &dev);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_DRAM);
 	if (ret) {
 		printf("DRAM init failed: %d\n", ret);
 		return;
 	}
+
+	bootstage_mark_name(BOOTSTAGE_ID_END_TPL, "end_tpl");
+#ifdef CONFIG_BOOTSTAGE_STASH
+	ret = bootstage_stash_default();
+	if (ret)
+		debug("Failed to stash bootstage: err=%d\n", ret);
+#endif
 #else
+#ifdef CONFIG_ROCKCHIP_TPL_BOOTSTAGE
+	dram_us = tpl_boot_us();
+#endif
 	sdram_init();
+#ifdef CONFIG_ROCKCHIP_TPL_BOOTSTAGE
+	tpl_bootstage_stash(tpl_us, dram_us, tpl_boot_us());
+#endif
 #endif
 
 #if defined(CONFIG_TPL_ROCKCHIP_BACK_TO_BROM) && !defined(CONFIG_TPL_BOARD_INIT)
@@ -14,4 +14,18 @@ void sandbox_eth_disable_response(int index, bool disable);
 
 void sandbox_eth_skip_timeout(void);
 
+void sandbox_eth_tftp_file(unsigned int size, int max_window, int drop_block);
+
+int sandbox_eth_tftp_acks(void);
+
+void sandbox_eth_nfs_file(unsigned int size, bool reorder);
+
+int sandbox_eth_nfs_reads(void);
+
+/* Content of the file served by the emulated TFTP and NFS servers */
+static inline unsigned char sandbox_eth_file_data(unsigned int offset)
+{
+	return offset ^ (offset >> 8) ^ (offset >> 16);
+}
+
 #endif /* __ETH_H */
@@ -110,4 +110,14 @@ int sandbox_pwm_get_config(struct udevice *dev, uint channel, uint *period_nsp,
  */
 void sandbox_sf_set_block_protect(struct udevice *dev, int bp_mask);
 
+/**
+ * sandbox_console_truetype_set_cache() - Switch the glyph cache on or off
+ *
+ * The cache starts off on sandbox. Switching it empties it.
+ *
+ * @dev: TrueType console device
+ * @enable: true to cache rendered characters
+ */
+void sandbox_console_truetype_set_cache(struct udevice *dev, bool enable);
+
 #endif
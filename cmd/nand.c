@@ -26,6 +26,7 @@
 #include <watchdog.h>
 #include <malloc.h>
 #include <asm/byteorder.h>
+#include <div64.h>
 #include <jffs2/jffs2.h>
 #include <nand.h>
 
@@ -310,6 +311,90 @@ static void nand_print_and_set_info(int idx)
 	env_set_hex("nand_erasesize", mtd->erasesize);
 }
 
+#ifdef CONFIG_CMD_NAND_BENCH
+static void nand_bench_report(const char *op, loff_t size, ulong ms)
+{
+	printf("  %-6s %8llu KiB in %6lu ms", op, size >> 10, ms);
+	if (ms)
+		printf(", %llu KiB/s", lldiv(size * 1000, ms) >> 10);
+	putc('\n');
+}
+
+/*
+ * Erase, write and read back the good blocks of [off, off + size), a block
+ * at a time so that writes and reads span many pages like an image flash.
+ */
+static int nand_bench(struct mtd_info *mtd, loff_t off, loff_t size)
+{
+	struct erase_info ei;
+	loff_t pos, done;
+	size_t retlen;
+	u_char *buf, *rbuf;
+	ulong start;
+	int i, ret = 0;
+
+	buf = malloc(mtd->erasesize);
+	rbuf = malloc(mtd->erasesize);
+	if (!buf || !rbuf) {
+		ret = -ENOMEM;
+		goto out;
+	}
+	for (i = 0; i < mtd->erasesize; i++)
+		buf[i] = i ^ (i >> 8);
+
+	done = 0;
+	start = get_timer(0);
+	for (pos = off; pos < off + size; pos += mtd->erasesize) {
+		if (mtd_block_isbad(mtd, pos))
+			continue;
+		memset(&ei, 0, sizeof(ei));
+		ei.mtd = mtd;
+		ei.addr = pos;
+		ei.len = mtd->erasesize;
+		ret = mtd_erase(mtd, &ei);
+		if (ret)
+			goto out;
+		done += mtd->erasesize;
+	}
+	nand_bench_report("erase", done, get_timer(start));
+
+	done = 0;
+	start = get_timer(0);
+	for (pos = off; pos < off + size; pos += mtd->erasesize) {
+		if (mtd_block_isbad(mtd, pos))
+			continue;
+		ret = mtd_write(mtd, pos, mtd->erasesize, &retlen, buf);
+		if (ret)
+			goto out;
+		done += mtd->erasesize;
+	}
+	nand_bench_report("write", done, get_timer(start));
+
+	done = 0;
+	start = get_timer(0);
+	for (pos = off; pos < off + size; pos += mtd->erasesize) {
+		if (mtd_block_isbad(mtd, pos))
+			continue;
+		ret = mtd_read(mtd, pos, mtd->erasesize, &retlen, rbuf);
+		if (ret && !mtd_is_bitflip(ret))
+			goto out;
+		ret = 0;
+		if (memcmp(buf, rbuf, mtd->erasesize)) {
+			printf("  data mismatch in block at 0x%llx\n", pos);
+			ret = -EIO;
+			goto out;
+		}
+		done += mtd->erasesize;
+	}
+	nand_bench_report("read", done, get_timer(start));
+
+out:
+	free(rbuf);
+	free(buf);
+	return ret;
+}
+#endif
+
 static int raw_access(struct mtd_info *mtd, ulong addr, loff_t off,
 		      ulong count, int read, int no_verify)
 {
@@ -699,6 +784,32 @@ static int do_nand(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 	}
 #endif
 
+#ifdef CONFIG_CMD_NAND_BENCH
+	if (strcmp(cmd, "bench") == 0) {
+		if (argc < 4)
+			goto usage;
+
+		if (!str2off(argv[2], &off) || !str2off(argv[3], &size)) {
+			puts("Offset or size is not a valid number\n");
+			return 1;
+		}
+
+		off = round_down(off, mtd->erasesize);
+		size = round_up(size, mtd->erasesize);
+		if (off + size > mtd->size) {
+			puts("Arguments beyond end of NAND\n");
+			return 1;
+		}
+
+		printf("\nNAND bench: device %d offset 0x%llx size 0x%llx\n",
+		       dev, off, size);
+		ret = nand_bench(mtd, off, size);
+		if (ret)
+			printf(" failed, error %d\n", ret);
+		return ret ? 1 : 0;
+	}
+#endif
+
 	if (strcmp(cmd, "markbad") == 0) {
 		argc -= 2;
 		argv += 2;
@@ -814,6 +925,9 @@ static char nand_help_text[] =
 #ifdef CONFIG_CMD_NAND_TORTURE
 	"nand torture off - torture one block at offset\n"
 	"nand torture off [size] - torture blocks from off to off+size\n"
+#endif
+#ifdef CONFIG_CMD_NAND_BENCH
+	"nand bench off size - measure erase/write/read speed (erases!)\n"
 #endif
 	"nand scrub [-y] off size | scrub.part partition | scrub.chip\n"
 	"    really clean NAND erasing bad blocks (UNSAFE)\n"
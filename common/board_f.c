@@ -699,22 +699,32 @@ static int jump_to_copy(void)
 /* Record the board_init_f() bootstage (after arch_cpu_init()) */
 static int initf_bootstage(void)
 {
-	bool from_spl = IS_ENABLED(CONFIG_SPL_BOOTSTAGE) &&
-			IS_ENABLED(CONFIG_BOOTSTAGE_STASH);
+	/*
+	 * Only read the stash if an earlier phase of this boot writes it.
+	 * Otherwise it may hold the records stashed for the OS by a previous
+	 * boot, or not be in DRAM yet.
+	 */
+	bool from_spl = IS_ENABLED(CONFIG_BOOTSTAGE_STASH) &&
+			(IS_ENABLED(CONFIG_SPL_BOOTSTAGE) ||
+			 IS_ENABLED(CONFIG_TPL_BOOTSTAGE) ||
+			 IS_ENABLED(CONFIG_ROCKCHIP_TPL_BOOTSTAGE));
 	int ret;
 
-	ret = bootstage_init(!from_spl);
+	ret = bootstage_init(false);
 	if (ret)
 		return ret;
-	if (from_spl) {
-		const void *stash = map_sysmem(CONFIG_BOOTSTAGE_STASH_ADDR,
-					       CONFIG_BOOTSTAGE_STASH_SIZE);
 
-		ret = bootstage_unstash(stash, CONFIG_BOOTSTAGE_STASH_SIZE);
-		if (ret && ret != -ENOENT) {
+	/*
+	 * Continue the timeline stashed by TPL/SPL, if any. The earlier
+	 * phases run on the same arch timer, so their records line up.
+	 */
+	ret = -ENOENT;
+	if (from_spl)
+		ret = bootstage_unstash_default();
+	if (ret) {
+		if (ret != -ENOENT)
 			debug("Failed to unstash bootstage: err=%d\n", ret);
-			return ret;
-		}
+		bootstage_add_record(BOOTSTAGE_ID_AWAKE, "reset", 0, 0);
 	}
 
 	bootstage_mark_name(BOOTSTAGE_ID_START_UBOOT_F, "board_init_f");
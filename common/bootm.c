@@ -24,6 +24,7 @@
 #endif
 #else
 #include "mkimage.h"
+#include <bootstage.h>
 #endif
 
 #include <command.h>
@@ -376,6 +377,7 @@ int bootm_decomp_image(int comp, ulong load, ulong image_start, int type,
 		       void *load_buf, void *image_buf, ulong image_len,
 		       uint unc_len, ulong *load_end)
 {
+	ulong start = bootstage_span_start();
 	int ret = 0;
 
 	*load_end = load;
@@ -453,6 +455,9 @@ int bootm_decomp_image(int comp, ulong load, ulong image_start, int type,
 	if (ret)
 		return handle_decomp_error(comp, image_len, unc_len, ret);
 	*load_end = load + image_len;
+	if (comp != IH_COMP_NONE)
+		bootstage_span(BOOTSTAGE_SPAN_DECOMP, genimg_get_comp_name(comp),
+			       start, image_len);
 
 	puts("OK\n");
 
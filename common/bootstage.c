@@ -11,14 +11,20 @@
  */
 
 #include <common.h>
+#include <div64.h>
 #include <linux/libfdt.h>
 #include <malloc.h>
+#include <mapmem.h>
 #include <linux/compiler.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
 enum {
 	RECORD_COUNT = CONFIG_BOOTSTAGE_RECORD_COUNT,
+#ifdef CONFIG_BOOTSTAGE_PROFILE
+	SPAN_COUNT = CONFIG_BOOTSTAGE_PROFILE_COUNT,
+	SPAN_NAME_LEN = 32,
+#endif
 };
 
 struct bootstage_record {
@@ -29,25 +35,32 @@ struct bootstage_record {
 	enum bootstage_id id;
 };
 
+#ifdef CONFIG_BOOTSTAGE_PROFILE
+/*
+ * Span names are copied, they are often device names which go away when
+ * the device is unbound (e.g. block devices on 'usb stop')
+ */
+struct bootstage_span {
+	struct bootstage_stash_span info;
+	char name[SPAN_NAME_LEN];
+};
+#endif
+
 struct bootstage_data {
 	uint rec_count;
 	uint next_id;
 	struct bootstage_record record[RECORD_COUNT];
+#ifdef CONFIG_BOOTSTAGE_PROFILE
+	uint span_count;
+	uint span_dropped;
+	struct bootstage_span span[SPAN_COUNT];
+#endif
 };
 
 enum {
-	BOOTSTAGE_VERSION	= 0,
-	BOOTSTAGE_MAGIC		= 0xb00757a3,
 	BOOTSTAGE_DIGITS	= 9,
 };
 
-struct bootstage_hdr {
-	uint32_t version;	/* BOOTSTAGE_VERSION */
-	uint32_t count;		/* Number of records */
-	uint32_t size;		/* Total data size (non-zero if valid) */
-	uint32_t magic;		/* Unused */
-};
-
 int bootstage_relocate(void)
 {
 	struct bootstage_data *data = gd->bootstage;
@@ -196,6 +209,98 @@ uint32_t bootstage_accum(enum bootstage_id id)
 	return duration;
 }
 
+#ifdef CONFIG_BOOTSTAGE_PROFILE
+static const char *const span_cat_name[BOOTSTAGE_SPAN_CAT_COUNT] = {
+	[BOOTSTAGE_SPAN_PROBE]		= "probe",
+	[BOOTSTAGE_SPAN_BLK_READ]	= "blk_read",
+	[BOOTSTAGE_SPAN_BLK_WRITE]	= "blk_write",
+	[BOOTSTAGE_SPAN_DECOMP]		= "decomp",
+	[BOOTSTAGE_SPAN_HASH]		= "hash",
+};
+
+void bootstage_span(enum bootstage_span_cat cat, const char *name,
+		    ulong start_us, ulong bytes)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_span *span;
+	uint32_t end_us = timer_get_boot_us();
+
+	if (!data)
+		return;
+
+	/* A block transfer continuing the last span is merged into it */
+	if ((cat == BOOTSTAGE_SPAN_BLK_READ ||
+	     cat == BOOTSTAGE_SPAN_BLK_WRITE) && data->span_count) {
+		span = &data->span[data->span_count - 1];
+		if (span->info.cat == cat &&
+		    !strncmp(span->name, name, sizeof(span->name) - 1) &&
+		    span->info.count < 0xffff &&
+		    bytes <= U32_MAX - span->info.bytes) {
+			span->info.end_us = end_us;
+			span->info.busy_us += end_us - (uint32_t)start_us;
+			span->info.bytes += bytes;
+			span->info.count++;
+			return;
+		}
+	}
+
+	if (data->span_count == SPAN_COUNT) {
+		data->span_dropped++;
+		return;
+	}
+
+	span = &data->span[data->span_count++];
+	span->info.start_us = start_us;
+	span->info.end_us = end_us;
+	span->info.busy_us = end_us - (uint32_t)start_us;
+	span->info.bytes = bytes;
+	span->info.count = 1;
+	span->info.cat = cat;
+	strlcpy(span->name, name, sizeof(span->name));
+}
+
+static void print_spans(struct bootstage_data *data)
+{
+	struct bootstage_span *span;
+	int i;
+
+	if (!data->span_count)
+		return;
+
+	printf("\nProfile in microseconds (%d spans):\n", data->span_count);
+	printf("%11s%11s%11s%13s%8s  %s\n", "Start", "Elapsed", "Busy",
+	       "Bytes", "KiB/s", "Span");
+	for (i = 0, span = data->span; i < data->span_count; i++, span++) {
+		struct bootstage_stash_span *info = &span->info;
+		ulong rate = 0;
+
+		if (info->bytes && info->busy_us)
+			rate = lldiv((u64)(info->bytes / 1024) * 1000000,
+				     info->busy_us);
+
+		print_grouped_ull(info->start_us, BOOTSTAGE_DIGITS);
+		print_grouped_ull(info->end_us - info->start_us,
+				  BOOTSTAGE_DIGITS);
+		print_grouped_ull(info->busy_us, BOOTSTAGE_DIGITS);
+		print_grouped_ull(info->bytes, BOOTSTAGE_DIGITS + 2);
+		/* Unstashed data is not trusted */
+		printf("%8lu  %s %s", rate,
+		       info->cat < BOOTSTAGE_SPAN_CAT_COUNT ?
+		       span_cat_name[info->cat] : "unknown", span->name);
+		if (info->count > 1)
+			printf(" (%u ops)", info->count);
+		printf("\n");
+	}
+	if (data->span_dropped)
+		printf("Dropped %d spans - please increase CONFIG_BOOTSTAGE_PROFILE_COUNT\n",
+		       data->span_dropped);
+}
+#else
+static void print_spans(struct bootstage_data *data)
+{
+}
+#endif
+
 /**
  * Get a record name as a printable string
  *
@@ -258,6 +363,11 @@ static int add_bootstages_devicetree(struct fdt_header *blob)
 	if (!blob)
 		return 0;
 
+	/* Replace the node of an earlier boot attempt */
+	bootstage = fdt_path_offset(blob, "/bootstage");
+	if (bootstage >= 0)
+		fdt_del_node(blob, bootstage);
+
 	/*
 	 * Create the node for bootstage.
 	 * The address of flat device tree is set up by the command bootm.
@@ -335,6 +445,8 @@ void bootstage_report(void)
 		if (rec->start_us)
 			prev = print_time_record(rec, -1);
 	}
+
+	print_spans(data);
 }
 
 /**
@@ -386,21 +498,50 @@ int bootstage_stash(void *base, int size)
 	hdr->count = count;
 	hdr->size = 0;
 	hdr->magic = BOOTSTAGE_MAGIC;
+#ifdef CONFIG_BOOTSTAGE_PROFILE
+	hdr->span_count = data->span_count;
+	hdr->span_dropped = data->span_dropped;
+#else
+	hdr->span_count = 0;
+	hdr->span_dropped = 0;
+#endif
 	ptr += sizeof(*hdr);
 
 	/* Write the records, silently stopping when we run out of space */
 	for (rec = data->record, i = 0; i < data->rec_count; i++, rec++) {
-		append_data(&ptr, end, rec, sizeof(*rec));
+		struct bootstage_stash_record srec;
+
+		if (rec->id == 0)
+			continue;
+		srec.time_us = rec->time_us;
+		srec.start_us = rec->start_us;
+		srec.flags = rec->flags;
+		srec.id = rec->id;
+		append_data(&ptr, end, &srec, sizeof(srec));
 	}
 
+#ifdef CONFIG_BOOTSTAGE_PROFILE
+	for (i = 0; i < data->span_count; i++)
+		append_data(&ptr, end, &data->span[i].info,
+			    sizeof(data->span[i].info));
+#endif
+
 	/* Write the name strings */
 	for (rec = data->record, i = 0; i < data->rec_count; i++, rec++) {
 		const char *name;
 
+		if (rec->id == 0)
+			continue;
 		name = get_record_name(buf, sizeof(buf), rec);
 		append_data(&ptr, end, name, strlen(name) + 1);
 	}
 
+#ifdef CONFIG_BOOTSTAGE_PROFILE
+	for (i = 0; i < data->span_count; i++)
+		append_data(&ptr, end, data->span[i].name,
+			    strlen(data->span[i].name) + 1);
+#endif
+
 	/* Check for buffer overflow */
 	if (ptr > end) {
 		debug("%s: Not enough space for bootstage stash\n", __func__);
@@ -409,7 +550,7 @@ int bootstage_stash(void *base, int size)
 
 	/* Update total data size */
 	hdr->size = ptr - (char *)base;
-	debug("Stashed %d records\n", hdr->count);
+	debug("Stashed %d records, %d spans\n", hdr->count, hdr->span_count);
 
 	return 0;
 }
@@ -419,8 +560,10 @@ int bootstage_unstash(const void *base, int size)
 	const struct bootstage_hdr *hdr = (struct bootstage_hdr *)base;
 	struct bootstage_data *data = gd->bootstage;
 	const char *ptr = base, *end = ptr + size;
+	const struct bootstage_stash_record *srec;
+	const struct bootstage_stash_span *sspan;
 	struct bootstage_record *rec;
-	uint rec_size;
+	uint rec_size, span_size;
 	int i;
 
 	if (size == -1)
@@ -441,49 +584,90 @@ int bootstage_unstash(const void *base, int size)
 		return -ENOSPC;
 	}
 
-	if (hdr->count * sizeof(*rec) > hdr->size) {
-		debug("%s: Bootstage has %d records needing %lu bytes, but "
-			"only %d bytes is available\n", __func__, hdr->count,
-		      (ulong)hdr->count * sizeof(*rec), hdr->size);
-		return -ENOSPC;
-	}
-
 	if (hdr->version != BOOTSTAGE_VERSION) {
 		debug("%s: Bootstage data version %#0x unrecognised\n",
 		      __func__, hdr->version);
 		return -EINVAL;
 	}
 
+	rec_size = hdr->count * sizeof(*srec);
+	span_size = hdr->span_count * sizeof(*sspan);
+	if (sizeof(*hdr) + rec_size + span_size > hdr->size) {
+		debug("%s: Bootstage has %d records and %d spans, but only %d bytes\n",
+		      __func__, hdr->count, hdr->span_count, hdr->size);
+		return -ENOSPC;
+	}
+
 	if (data->rec_count + hdr->count > RECORD_COUNT) {
 		debug("%s: Bootstage has %d records, we have space for %d\n"
-			"- please increase CONFIG_BOOTSTAGE_USER_COUNT\n",
+			"- please increase CONFIG_BOOTSTAGE_RECORD_COUNT\n",
 		      __func__, hdr->count, RECORD_COUNT - data->rec_count);
 		return -ENOSPC;
 	}
 
 	ptr += sizeof(*hdr);
-
-	/* Read the records */
-	rec_size = hdr->count * sizeof(*data->record);
-	memcpy(data->record + data->rec_count, ptr, rec_size);
-
-	/* Read the name strings */
-	ptr += rec_size;
-	for (rec = data->record + data->next_id, i = 0; i < hdr->count;
-	     i++, rec++) {
+	srec = (const struct bootstage_stash_record *)ptr;
+	sspan = (const struct bootstage_stash_span *)(ptr + rec_size);
+	ptr += rec_size + span_size;
+
+	/* Read the records and their name strings */
+	for (rec = data->record + data->rec_count, i = 0; i < hdr->count;
+	     i++, rec++, srec++) {
+		rec->time_us = srec->time_us;
+		rec->start_us = srec->start_us;
+		rec->flags = srec->flags;
+		rec->id = srec->id;
 		rec->name = ptr;
+		if (rec->id >= data->next_id && rec->id < BOOTSTAGE_ID_ALLOC)
+			data->next_id = rec->id + 1;
 
 		/* Assume no data corruption here */
 		ptr += strlen(ptr) + 1;
 	}
-
-	/* Mark the records as read */
 	data->rec_count += hdr->count;
-	debug("Unstashed %d records\n", hdr->count);
+
+#ifdef CONFIG_BOOTSTAGE_PROFILE
+	/* Then the spans, as far as they fit */
+	for (i = 0; i < hdr->span_count; i++, sspan++) {
+		struct bootstage_span *span;
+
+		if (data->span_count == SPAN_COUNT) {
+			data->span_dropped += hdr->span_count - i;
+			break;
+		}
+		span = &data->span[data->span_count++];
+		span->info = *sspan;
+		strlcpy(span->name, ptr, sizeof(span->name));
+		ptr += strlen(ptr) + 1;
+	}
+	data->span_dropped += hdr->span_dropped;
+#endif
+	debug("Unstashed %d records, %d spans\n", hdr->count, hdr->span_count);
 
 	return 0;
 }
 
+int bootstage_stash_default(void)
+{
+	return bootstage_stash(map_sysmem(CONFIG_BOOTSTAGE_STASH_ADDR,
+					  CONFIG_BOOTSTAGE_STASH_SIZE),
+			       CONFIG_BOOTSTAGE_STASH_SIZE);
+}
+
+int bootstage_unstash_default(void)
+{
+	struct bootstage_hdr *hdr = map_sysmem(CONFIG_BOOTSTAGE_STASH_ADDR,
+					       CONFIG_BOOTSTAGE_STASH_SIZE);
+	int ret;
+
+	ret = bootstage_unstash(hdr, CONFIG_BOOTSTAGE_STASH_SIZE);
+	/* Consumed, or unusable: a later boot must not find it again */
+	if (ret != -ENOENT)
+		hdr->magic = 0;
+
+	return ret;
+}
+
 int bootstage_get_size(void)
 {
 	return sizeof(struct bootstage_data);
@@ -499,10 +683,9 @@ int bootstage_init(bool first)
 		return -ENOMEM;
 	data = gd->bootstage;
 	memset(data, '\0', size);
-	if (first) {
-		data->next_id = BOOTSTAGE_ID_USER;
+	data->next_id = BOOTSTAGE_ID_USER;
+	if (first)
 		bootstage_add_record(BOOTSTAGE_ID_AWAKE, "reset", 0, 0);
-	}
 
 	return 0;
 }
@@ -5412,31 +5412,38 @@ drm_do_probe_ddc_edid(struct ddc_adapter *adap, u8 *buf, unsigned int block,
 	return ret == xfers ? 0 : -1;
 }
 
-int drm_do_get_edid(struct ddc_adapter *adap, u8 *edid)
+/* Fetch the base block only, e.g. to identify the sink */
+int drm_do_get_edid_base(struct ddc_adapter *adap, u8 *edid)
 {
-	int i, j, block_num, block = 0;
 	bool edid_corrupt;
-#ifdef DEBUG
-	u8 *buff;
-#endif
+	int i;
 
-	/* base block fetch */
 	for (i = 0; i < 4; i++) {
 		if (drm_do_probe_ddc_edid(adap, edid, 0, HDMI_EDID_BLOCK_SIZE))
 			goto err;
 		if (drm_edid_block_valid(edid, 0, true,
 					 &edid_corrupt))
-			break;
+			return 0;
 		if (i == 0 && drm_edid_is_zero(edid, HDMI_EDID_BLOCK_SIZE)) {
 			printf("edid base block is 0, get edid failed\n");
 			goto err;
 		}
 	}
 
-	if (i == 4)
-		goto err;
+err:
+	printf("can't get edid block:0\n");
+	memset(edid, 0, HDMI_EDID_BLOCK_SIZE);
+	return -EFAULT;
+}
+
+/* Fetch the extension blocks announced by the base block in @edid */
+int drm_do_get_edid_ext(struct ddc_adapter *adap, u8 *edid)
+{
+	int i, j, block_num, block = 1;
+#ifdef DEBUG
+	u8 *buff;
+#endif
 
-	block++;
 	/* get the number of extensions */
 	block_num = edid[0x7e];
 
@@ -5477,6 +5484,15 @@ err:
 	return -EFAULT;
 }
 
+int drm_do_get_edid(struct ddc_adapter *adap, u8 *edid)
+{
+	/* base block fetch */
+	if (drm_do_get_edid_base(adap, edid))
+		return -EFAULT;
+
+	return drm_do_get_edid_ext(adap, edid);
+}
+
 static ssize_t hdmi_ddc_read(struct ddc_adapter *adap, u16 addr, u8 offset,
 			     void *buffer, size_t size)
 {
@@ -26,6 +26,19 @@ DECLARE_GLOBAL_DATA_PTR;
 #ifndef CONFIG_SYS_UBOOT_START
 #define CONFIG_SYS_UBOOT_START	CONFIG_SYS_TEXT_BASE
 #endif
+
+/* TPL and SPL share this file, keep their bootstage records apart */
+#ifdef CONFIG_TPL_BUILD
+#define PHASE_ID_START		BOOTSTAGE_ID_START_TPL
+#define PHASE_ID_END		BOOTSTAGE_ID_END_TPL
+#define PHASE_ID_ACCUM_DM	BOOTSTATE_ID_ACCUM_DM_TPL
+#define PHASE_NAME		"tpl"
+#else
+#define PHASE_ID_START		BOOTSTAGE_ID_START_SPL
+#define PHASE_ID_END		BOOTSTAGE_ID_END_SPL
+#define PHASE_ID_ACCUM_DM	BOOTSTATE_ID_ACCUM_DM_SPL
+#define PHASE_NAME		"spl"
+#endif
 #ifndef CONFIG_SYS_MONITOR_LEN
 /* Unknown U-Boot size, let's assume it will not be more than 200 KB */
 #define CONFIG_SYS_MONITOR_LEN	(200 * 1024)
@@ -221,6 +234,29 @@ __weak void __noreturn jump_to_image_no_args(struct spl_image_info *spl_image)
 	image_entry();
 }
 
+/*
+ * Set up bootstage. SPL running after TPL continues the timeline stashed
+ * by TPL (which has set up DRAM by then), any other phase starts one.
+ */
+static int spl_bootstage_init(void)
+{
+	int ret;
+
+	ret = bootstage_init(false);
+	if (ret)
+		return ret;
+#if defined(CONFIG_TPL) && !defined(CONFIG_TPL_BUILD) && \
+	defined(CONFIG_BOOTSTAGE_STASH)
+	if (!bootstage_unstash_default()) {
+		/* The names point into the stash, which SPL rewrites */
+		return bootstage_relocate();
+	}
+#endif
+	bootstage_add_record(BOOTSTAGE_ID_AWAKE, "reset", 0, 0);
+
+	return 0;
+}
+
 static int spl_common_init(bool setup_malloc)
 {
 	int ret;
@@ -236,13 +272,13 @@ static int spl_common_init(bool setup_malloc)
 		gd->malloc_ptr = 0;
 	}
 #endif
-	ret = bootstage_init(true);
+	ret = spl_bootstage_init();
 	if (ret) {
 		debug("%s: Failed to set up bootstage: ret=%d\n", __func__,
 		      ret);
 		return ret;
 	}
-	bootstage_mark_name(BOOTSTAGE_ID_START_SPL, "spl");
+	bootstage_mark_name(PHASE_ID_START, PHASE_NAME);
 	if (CONFIG_IS_ENABLED(OF_CONTROL) && !CONFIG_IS_ENABLED(OF_PLATDATA)) {
 		ret = fdtdec_setup();
 		if (ret) {
@@ -251,10 +287,10 @@ static int spl_common_init(bool setup_malloc)
 		}
 	}
 	if (CONFIG_IS_ENABLED(DM)) {
-		bootstage_start(BOOTSTATE_ID_ACCUM_DM_SPL, "dm_spl");
+		bootstage_start(PHASE_ID_ACCUM_DM, "dm_" PHASE_NAME);
 		/* With CONFIG_SPL_OF_PLATDATA, bring in all devices */
 		ret = dm_init_and_scan(!CONFIG_IS_ENABLED(OF_PLATDATA));
-		bootstage_accum(BOOTSTATE_ID_ACCUM_DM_SPL);
+		bootstage_accum(PHASE_ID_ACCUM_DM);
 		if (ret) {
 			debug("dm_init_and_scan() returned error %d\n", ret);
 			return ret;
@@ -399,9 +435,10 @@ static int spl_initr_dm(void)
 	/* Save the pre-reloc driver model and start a new one */
 	gd->dm_root_f = gd->dm_root;
 	gd->dm_root = NULL;
-	bootstage_start(BOOTSTATE_ID_ACCUM_DM_R, "dm_r");
+	/* "dm_r" belongs to U-Boot proper, count this as SPL time */
+	bootstage_start(BOOTSTATE_ID_ACCUM_DM_SPL, "dm_spl");
 	ret = dm_init_and_scan(false);
-	bootstage_accum(BOOTSTATE_ID_ACCUM_DM_R);
+	bootstage_accum(BOOTSTATE_ID_ACCUM_DM_SPL);
 	if (ret)
 		return ret;
 
@@ -489,6 +526,19 @@ void board_init_r(gd_t *dummy1, ulong dummy2)
 #ifdef CONFIG_CPU_V7M
 	spl_image.entry_point |= 0x1;
 #endif
+
+	/*
+	 * Stash before any of the jumps below: ATF and OP-TEE do not come
+	 * back, the next records are made by U-Boot proper.
+	 */
+	bootstage_mark_name(PHASE_ID_END, "end_" PHASE_NAME);
+#ifdef CONFIG_BOOTSTAGE_STASH
+	int ret = bootstage_stash_default();
+
+	if (ret)
+		debug("Failed to stash bootstage: err=%d\n", ret);
+#endif
+
 	switch (spl_image.os) {
 	case IH_OS_U_BOOT:
 		debug("Jumping to U-Boot\n");
@@ -521,17 +571,6 @@ void board_init_r(gd_t *dummy1, ulong dummy2)
 	      gd->malloc_ptr / 1024);
 #endif
 
-	debug("loaded - jumping to U-Boot...\n");
-#ifdef CONFIG_BOOTSTAGE_STASH
-	int ret;
-
-	bootstage_mark_name(BOOTSTAGE_ID_END_SPL, "end_spl");
-	ret = bootstage_stash((void *)CONFIG_BOOTSTAGE_STASH_ADDR,
-			      CONFIG_BOOTSTAGE_STASH_SIZE);
-	if (ret)
-		debug("Failed to stash bootstage: err=%d\n", ret);
-#endif
-
 	debug("loaded - jumping to U-Boot...\n");
 	spl_board_prepare_for_boot();
 	jump_to_image_no_args(&spl_image);
@@ -8,6 +8,7 @@
 #include <common.h>
 #include <command.h>
 #include <errno.h>
+#include <fs.h>
 #include <ide.h>
 #include <malloc.h>
 #include <part.h>
@@ -235,6 +236,9 @@ void part_init(struct blk_desc *dev_desc)
 	struct part_driver *entry;
 
 	blkcache_invalidate(dev_desc->if_type, dev_desc->devnum);
+	blkra_invalidate(dev_desc);
+	/* New medium or hardware partition, cached lookups are stale */
+	fs_dcache_invalidate();
 
 	dev_desc->part_type = PART_TYPE_UNKNOWN;
 	for (entry = drv; entry != drv + n_ents; entry++) {
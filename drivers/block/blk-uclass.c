@@ -417,6 +417,7 @@ unsigned long blk_dread(struct blk_desc *block_dev, lbaint_t start,
 {
 	struct udevice *dev = block_dev->bdev;
 	const struct blk_ops *ops = blk_get_ops(dev);
+	ulong span_start = bootstage_span_start();
 	ulong blks_read;
 
 	if (!ops->read)
@@ -425,10 +426,18 @@ unsigned long blk_dread(struct blk_desc *block_dev, lbaint_t start,
 	if (blkcache_read(block_dev->if_type, block_dev->devnum,
 			  start, blkcnt, block_dev->blksz, buffer))
 		return blkcnt;
+	if (blkra_read(block_dev, start, blkcnt, buffer)) {
+		blks_read = blkcnt;
+		goto out;
+	}
 	blks_read = ops->read(dev, start, blkcnt, buffer);
 	if (blks_read == blkcnt)
 		blkcache_fill(block_dev->if_type, block_dev->devnum,
 			      start, blkcnt, block_dev->blksz, buffer);
+out:
+	if (!IS_ERR_VALUE(blks_read))
+		bootstage_span(BOOTSTAGE_SPAN_BLK_READ, dev->name, span_start,
+			       blks_read * block_dev->blksz);
 
 	return blks_read;
 }
@@ -438,12 +447,20 @@ unsigned long blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 {
 	struct udevice *dev = block_dev->bdev;
 	const struct blk_ops *ops = blk_get_ops(dev);
+	ulong span_start = bootstage_span_start();
+	ulong blks_written;
 
 	if (!ops->write)
 		return -ENOSYS;
 
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
-	return ops->write(dev, start, blkcnt, buffer);
+	blkra_invalidate(block_dev);
+	blks_written = ops->write(dev, start, blkcnt, buffer);
+	if (!IS_ERR_VALUE(blks_written))
+		bootstage_span(BOOTSTAGE_SPAN_BLK_WRITE, dev->name, span_start,
+			       blks_written * block_dev->blksz);
+
+	return blks_written;
 }
 
 unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
@@ -456,6 +473,7 @@ unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
 		return -ENOSYS;
 
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	blkra_invalidate(block_dev);
 	return ops->erase(dev, start, blkcnt);
 }
 
@@ -632,8 +650,18 @@ int blk_unbind_all(int if_type)
 	return 0;
 }
 
+static int blk_pre_unbind(struct udevice *dev)
+{
+	struct blk_desc *desc = dev_get_uclass_platdata(dev);
+
+	blkra_release(desc);
+
+	return 0;
+}
+
 UCLASS_DRIVER(blk) = {
 	.id		= UCLASS_BLK,
 	.name		= "blk",
+	.pre_unbind	= blk_pre_unbind,
 	.per_device_platdata_auto_alloc_size = sizeof(struct blk_desc),
 };
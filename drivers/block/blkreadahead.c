@@ -0,0 +1,220 @@
+/*
+ * (C) Copyright 2020 Rockchip Electronics Co., Ltd
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+/*
+ * Sequential read-ahead for block devices.
+ *
+ * Filesystem loaders stream large files through many small blk_dread()
+ * calls (one per extent or cluster run plus metadata). One read-ahead
+ * window is kept per block device: once a read continues where the
+ * previous one stopped, or falls in a range announced by blk_prefetch(),
+ * the following CONFIG_BLOCK_READAHEAD_BLOCKS blocks are fetched with a
+ * single device transfer and later reads are served from the window.
+ */
+
+#include <common.h>
+#include <blk.h>
+#include <dm.h>
+#include <malloc.h>
+#include <memalign.h>
+
+#define BLKRA_DEVS	4
+#define BLKRA_HINTS	16
+
+struct blkra_hint {
+	lbaint_t start;
+	lbaint_t blkcnt;
+};
+
+struct blkra_dev {
+	struct udevice *bdev;
+	unsigned char hwpart;
+	unsigned long blksz;
+	lbaint_t next;		/* block following the last read */
+	lbaint_t start;		/* first block held in the window */
+	lbaint_t blkcnt;	/* number of valid blocks in the window */
+	char *buf;
+	struct blkra_hint hint[BLKRA_HINTS];
+	int hints;
+};
+
+static struct blkra_dev blkra_devs[BLKRA_DEVS];
+
+static struct blkra_dev *blkra_get(struct blk_desc *desc, bool create)
+{
+	struct blkra_dev *ra, *free_ra = NULL;
+	int i;
+
+	for (i = 0; i < BLKRA_DEVS; i++) {
+		ra = &blkra_devs[i];
+		if (ra->bdev == desc->bdev && ra->hwpart == desc->hwpart &&
+		    ra->blksz == desc->blksz)
+			return ra;
+		if (!ra->bdev && !free_ra)
+			free_ra = ra;
+	}
+
+	if (!create)
+		return NULL;
+
+	/* Recycle the first slot rather than fail, it is only a cache */
+	if (!free_ra) {
+		free_ra = &blkra_devs[0];
+		free(free_ra->buf);
+	}
+
+	ra = free_ra;
+	memset(ra, 0, sizeof(*ra));
+	ra->buf = malloc_cache_aligned(CONFIG_BLOCK_READAHEAD_BLOCKS *
+				       desc->blksz);
+	if (!ra->buf)
+		return NULL;
+	ra->bdev = desc->bdev;
+	ra->hwpart = desc->hwpart;
+	ra->blksz = desc->blksz;
+	ra->next = (lbaint_t)-1;
+
+	return ra;
+}
+
+/* Return the number of hinted blocks from @start onwards, 0 if none */
+static lbaint_t blkra_hinted(struct blkra_dev *ra, lbaint_t start)
+{
+	int i;
+
+	for (i = 0; i < ra->hints; i++) {
+		struct blkra_hint *h = &ra->hint[i];
+
+		if (start >= h->start && start < h->start + h->blkcnt)
+			return h->start + h->blkcnt - start;
+	}
+
+	return 0;
+}
+
+int blk_prefetch(struct blk_desc *desc, lbaint_t start, lbaint_t blkcnt)
+{
+	struct blkra_dev *ra;
+	struct blkra_hint *h;
+
+	if (!blkcnt)
+		return 0;
+
+	ra = blkra_get(desc, true);
+	if (!ra)
+		return -ENOMEM;
+
+	/* Extend the previous hint when the extents are adjacent */
+	if (ra->hints) {
+		h = &ra->hint[ra->hints - 1];
+		if (h->start + h->blkcnt == start) {
+			h->blkcnt += blkcnt;
+			return 0;
+		}
+	}
+
+	/* Keep the most recent hints */
+	if (ra->hints == BLKRA_HINTS) {
+		memmove(&ra->hint[0], &ra->hint[1],
+			(BLKRA_HINTS - 1) * sizeof(*h));
+		ra->hints--;
+	}
+	h = &ra->hint[ra->hints++];
+	h->start = start;
+	h->blkcnt = blkcnt;
+
+	return 0;
+}
+
+ulong blkra_read(struct blk_desc *desc, lbaint_t start, lbaint_t blkcnt,
+		 void *buffer)
+{
+	const struct blk_ops *ops = blk_get_ops(desc->bdev);
+	struct blkra_dev *ra;
+	lbaint_t count, hinted;
+	ulong n;
+
+	ra = blkra_get(desc, false);
+
+	/* Served from the window */
+	if (ra && ra->blkcnt && start >= ra->start &&
+	    start + blkcnt <= ra->start + ra->blkcnt) {
+		memcpy(buffer, ra->buf + (start - ra->start) * desc->blksz,
+		       blkcnt * desc->blksz);
+		ra->next = start + blkcnt;
+		return blkcnt;
+	}
+
+	/* Large transfers are already efficient, just track the position */
+	if (blkcnt >= CONFIG_BLOCK_READAHEAD_BLOCKS) {
+		if (ra)
+			ra->next = start + blkcnt;
+		return 0;
+	}
+
+	hinted = ra ? blkra_hinted(ra, start) : 0;
+	if (!hinted && (!ra || start != ra->next)) {
+		ra = blkra_get(desc, true);
+		if (ra)
+			ra->next = start + blkcnt;
+		return 0;
+	}
+
+	/* Past the end, let the driver report the error */
+	if (start >= desc->lba)
+		return 0;
+
+	count = CONFIG_BLOCK_READAHEAD_BLOCKS;
+	if (hinted && hinted > blkcnt && hinted < count)
+		count = hinted;
+	if (start + count > desc->lba)
+		count = desc->lba - start;
+	if (count <= blkcnt)
+		return 0;
+
+	ra->blkcnt = 0;
+	n = ops->read(desc->bdev, start, count, ra->buf);
+	if (IS_ERR_VALUE(n) || n < blkcnt)
+		return 0;
+
+	debug("%s: start " LBAF ", count " LBAFU ", window " LBAFU "\n",
+	      __func__, start, blkcnt, (lbaint_t)n);
+	ra->start = start;
+	ra->blkcnt = n;
+	ra->next = start + blkcnt;
+	memcpy(buffer, ra->buf, blkcnt * desc->blksz);
+
+	return blkcnt;
+}
+
+void blkra_invalidate(struct blk_desc *desc)
+{
+	int i;
+
+	for (i = 0; i < BLKRA_DEVS; i++) {
+		struct blkra_dev *ra = &blkra_devs[i];
+
+		if (ra->bdev != desc->bdev)
+			continue;
+		ra->blkcnt = 0;
+		ra->hints = 0;
+		ra->next = (lbaint_t)-1;
+	}
+}
+
+void blkra_release(struct blk_desc *desc)
+{
+	int i;
+
+	for (i = 0; i < BLKRA_DEVS; i++) {
+		struct blkra_dev *ra = &blkra_devs[i];
+
+		if (ra->bdev != desc->bdev)
+			continue;
+		free(ra->buf);
+		memset(ra, 0, sizeof(*ra));
+	}
+}
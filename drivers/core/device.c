@@ -426,11 +426,14 @@ int device_probe(struct udevice *dev)
 	}
 
 	if (drv->probe) {
+		ulong start = bootstage_span_start();
+
 		ret = drv->probe(dev);
 		if (ret) {
 			dev->flags &= ~DM_FLAG_ACTIVATED;
 			goto fail;
 		}
+		bootstage_span(BOOTSTAGE_SPAN_PROBE, dev->name, start, 0);
 	}
 
 	ret = uclass_post_probe_device(dev);
@@ -12,12 +12,56 @@
 #include <malloc.h>
 #include <nand.h>
 #include <part.h>
+#include <mtd_blk.h>
 #include <dm/device-internal.h>
 
 #define MTD_PART_NAND_HEAD		"mtdparts="
 #define MTD_PART_INFO_MAX_SIZE		512
 #define MTD_SINGLE_PART_INFO_MAX_SIZE	40
 
+/* Map entry of a logical block past the good blocks of its partition */
+#define MTD_BLK_NO_BLOCK		0xffffffff
+/* Map entry of a logical block whose range has not been checked yet */
+#define MTD_BLK_UNMAPPED		0xfffffffe
+/* Every partition plus the gaps before, between and after them */
+#define MTD_BLK_MAX_RANGES		(2 * MAX_SEARCH_PARTITIONS + 1)
+
+enum mtd_blk_map_state {
+	MTD_BLK_MAP_NONE,
+	MTD_BLK_MAP_BUILDING,
+	MTD_BLK_MAP_READY,
+};
+
+/**
+ * struct mtd_blk_range - eraseblocks mapped together
+ *
+ * @first: first eraseblock of a partition, or of a gap between partitions
+ * @last: eraseblock following it
+ */
+struct mtd_blk_range {
+	u32 first;
+	u32 last;
+};
+
+/**
+ * struct mtd_blk_priv - skip-bad block map of an MTD block device
+ *
+ * @map: physical eraseblock holding each logical eraseblock
+ * @nblocks: number of eraseblocks in @map
+ * @range: ranges covering all of @map, each one mapped on its own
+ * @nranges: number of entries in @range
+ * @badblocks: bad block count of the MTD device when @map was set up
+ * @state: state of @map
+ */
+struct mtd_blk_priv {
+	u32 *map;
+	u32 nblocks;
+	struct mtd_blk_range *range;
+	int nranges;
+	u32 badblocks;
+	enum mtd_blk_map_state state;
+};
+
 char *mtd_part_parse(void)
 {
 	char mtd_part_info_temp[MTD_SINGLE_PART_INFO_MAX_SIZE] = {0};
@@ -92,6 +136,174 @@ char *mtd_part_parse(void)
 	return mtd_part_info;
 }
 
+#if defined(CONFIG_NAND) || defined(CONFIG_MTD_SPI_NAND)
+/* Map eraseblocks [first, last) to the good blocks of the same range */
+static void mtd_blk_map_range(struct mtd_info *mtd, struct mtd_blk_priv *priv,
+			      u32 first, u32 last)
+{
+	u32 i, phys = first;
+
+	for (i = first; i < last; i++) {
+		while (phys < last &&
+		       mtd_block_isbad(mtd, (loff_t)phys * mtd->erasesize))
+			phys++;
+		priv->map[i] = phys < last ? phys++ : MTD_BLK_NO_BLOCK;
+	}
+}
+
+static void mtd_blk_add_range(struct mtd_blk_priv *priv, u32 first, u32 last)
+{
+	priv->range[priv->nranges].first = first;
+	priv->range[priv->nranges].last = last;
+	priv->nranges++;
+}
+
+/*
+ * Images are written to NAND skipping the bad blocks of their partition,
+ * so each partition, and each gap between them, is mapped on its own.
+ * Only the ranges are set up here: a range is checked for bad blocks the
+ * first time one of its blocks is read.
+ */
+static int mtd_blk_map_init(struct udevice *udev, struct mtd_info *mtd)
+{
+	struct mtd_blk_priv *priv = dev_get_priv(udev);
+	struct blk_desc *desc = dev_get_uclass_platdata(udev);
+	u32 nblocks = mtd_div_by_eb(mtd->size, mtd);
+	u32 i, first, last, next = 0;
+	disk_partition_t info;
+	int p;
+
+	if (!priv->map) {
+		priv->map = malloc(nblocks * sizeof(*priv->map));
+		priv->range = malloc(MTD_BLK_MAX_RANGES * sizeof(*priv->range));
+		if (!priv->map || !priv->range) {
+			free(priv->map);
+			free(priv->range);
+			priv->map = NULL;
+			priv->range = NULL;
+			return -ENOMEM;
+		}
+	}
+
+	for (i = 0; i < nblocks; i++)
+		priv->map[i] = MTD_BLK_UNMAPPED;
+
+	/* Partition table reads below use the unmapped path */
+	priv->state = MTD_BLK_MAP_BUILDING;
+	priv->badblocks = mtd->ecc_stats.badblocks;
+	priv->nranges = 0;
+
+	for (p = 1; p < MAX_SEARCH_PARTITIONS; p++) {
+		if (part_get_info(desc, p, &info))
+			break;
+
+		first = mtd_div_by_eb((u64)info.start << 9, mtd);
+		last = DIV_ROUND_UP((u64)(info.start + info.size) << 9,
+				    mtd->erasesize);
+		if (first < next || last > nblocks)
+			continue;
+		if (first > next)
+			mtd_blk_add_range(priv, next, first);
+		mtd_blk_add_range(priv, first, last);
+		next = last;
+	}
+	if (next < nblocks)
+		mtd_blk_add_range(priv, next, nblocks);
+
+	priv->nblocks = nblocks;
+	priv->state = MTD_BLK_MAP_READY;
+
+	/* Anything cached while setting up was read without the map */
+	blkcache_invalidate(desc->if_type, desc->devnum);
+	blkra_invalidate(desc);
+
+	return 0;
+}
+
+/* Map the range holding @block, checking its blocks for badness */
+static void mtd_blk_map_block(struct mtd_info *mtd, struct mtd_blk_priv *priv,
+			      u32 block)
+{
+	struct mtd_blk_range *range;
+	int i;
+
+	for (i = 0, range = priv->range; i < priv->nranges; i++, range++) {
+		if (block >= range->first && block < range->last) {
+			mtd_blk_map_range(mtd, priv, range->first, range->last);
+			return;
+		}
+	}
+}
+
+static bool mtd_blk_map_ready(struct udevice *udev, struct mtd_info *mtd)
+{
+	struct mtd_blk_priv *priv = dev_get_priv(udev);
+
+	if (priv->state == MTD_BLK_MAP_BUILDING)
+		return false;
+
+	/* A block went bad (mark-bad, failed erase) since it was set up */
+	if (priv->state == MTD_BLK_MAP_READY &&
+	    priv->badblocks != mtd->ecc_stats.badblocks)
+		priv->state = MTD_BLK_MAP_NONE;
+
+	if (priv->state == MTD_BLK_MAP_NONE && mtd_blk_map_init(udev, mtd))
+		return false;
+
+	return true;
+}
+
+/*
+ * Read through the map, with one MTD read for each run of logical blocks
+ * mapped to consecutive physical blocks.
+ */
+static int mtd_blk_map_read(struct udevice *udev, struct mtd_info *mtd,
+			    loff_t off, size_t size, u_char *dst)
+{
+	struct mtd_blk_priv *priv = dev_get_priv(udev);
+	u32 block, n, phys;
+	size_t len, retlen;
+	int ret;
+
+	while (size) {
+		block = mtd_div_by_eb(off, mtd);
+		if (block >= priv->nblocks)
+			return -EINVAL;
+		if (priv->map[block] == MTD_BLK_UNMAPPED)
+			mtd_blk_map_block(mtd, priv, block);
+		phys = priv->map[block];
+		if (phys == MTD_BLK_NO_BLOCK || phys == MTD_BLK_UNMAPPED)
+			return -EIO;
+
+		len = mtd->erasesize - mtd_mod_by_eb(off, mtd);
+		for (n = 1; len < size && block + n < priv->nblocks &&
+		     priv->map[block + n] == phys + n; n++)
+			len += mtd->erasesize;
+		len = min(len, size);
+
+		ret = mtd_read(mtd, (loff_t)phys * mtd->erasesize +
+			       mtd_mod_by_eb(off, mtd), len, &retlen, dst);
+		if (ret && ret != -EUCLEAN)
+			return ret;
+
+		off += len;
+		dst += len;
+		size -= len;
+	}
+
+	return 0;
+}
+
+static int mtd_blk_nand_read(struct udevice *udev, struct mtd_info *mtd,
+			     loff_t off, size_t size, u_char *dst)
+{
+	if (mtd_blk_map_ready(udev, mtd))
+		return mtd_blk_map_read(udev, mtd, off, size, dst);
+
+	return nand_read_skip_bad(mtd, off, &size, NULL, mtd->size, dst);
+}
+#endif
+
 ulong mtd_dread(struct udevice *udev, lbaint_t start,
 		lbaint_t blkcnt, void *dst)
 {
@@ -117,9 +329,8 @@ ulong mtd_dread(struct udevice *udev, lbaint_t start,
 		if (!mtd)
 			return 0;
 
-		ret = nand_read_skip_bad(mtd, off, &rwsize,
-					 NULL, mtd->size,
-					 (u_char *)(dst));
+		ret = mtd_blk_nand_read(udev, mtd, off, rwsize,
+					(u_char *)(dst));
 		if (!ret)
 			return blkcnt;
 		else
@@ -127,9 +338,8 @@ ulong mtd_dread(struct udevice *udev, lbaint_t start,
 			return 0;
 	} else if (desc->devnum == BLK_MTD_SPI_NAND) {
 #ifdef CONFIG_MTD_SPI_NAND
-		ret = nand_read_skip_bad(mtd, off, &rwsize,
-					 NULL, mtd->size,
-					 (u_char *)(dst));
+		ret = mtd_blk_nand_read(udev, mtd, off, rwsize,
+					(u_char *)(dst));
 		if (!ret)
 			return blkcnt;
 		else
@@ -189,4 +399,5 @@ U_BOOT_DRIVER(mtd_blk) = {
 	.id		= UCLASS_BLK,
 	.ops		= &mtd_blk_ops,
 	.probe		= mtd_blk_probe,
+	.priv_auto_alloc_size = sizeof(struct mtd_blk_priv),
 };
@@ -1262,6 +1262,30 @@ int nand_prog_page_end_op(struct nand_chip *chip)
 }
 EXPORT_SYMBOL_GPL(nand_prog_page_end_op);
 
+/**
+ * nand_prog_page_cache_end_op - ends a PROG PAGE operation with a cache program
+ * @chip: The NAND chip
+ *
+ * This function issues the second half of a PROG PAGE operation with the
+ * CACHEDPROG command: the chip moves the data to its cache register and
+ * starts programming while the next page is already transferred. It only
+ * waits for the cache register to be free, the result of the program is
+ * in the FAIL_N1 status bit after the next program.
+ * This function does not select/unselect the CS line.
+ *
+ * Returns 0 on success, a negative error code otherwise.
+ */
+int nand_prog_page_cache_end_op(struct nand_chip *chip)
+{
+	struct mtd_info *mtd = nand_to_mtd(chip);
+
+	chip->cmdfunc(mtd, NAND_CMD_CACHEDPROG, -1, -1);
+	chip->waitfunc(mtd, chip);
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(nand_prog_page_cache_end_op);
+
 /**
  * nand_prog_page_op - Do a full PROG PAGE operation
  * @chip: The NAND chip
@@ -3083,11 +3107,12 @@ static int nand_write_page_syndrome(struct mtd_info *mtd,
  * @buf: the data to write
  * @oob_required: must write chip->oob_poi to OOB
  * @page: page number to write
+ * @cached: end with a cache program, the next page follows
  * @raw: use _raw version of write_page
  */
 static int nand_write_page(struct mtd_info *mtd, struct nand_chip *chip,
 		uint32_t offset, int data_len, const uint8_t *buf,
-		int oob_required, int page, int raw)
+		int oob_required, int page, int cached, int raw)
 {
 	int status, subpage;
 
@@ -3116,8 +3141,11 @@ static int nand_write_page(struct mtd_info *mtd, struct nand_chip *chip,
 	if (status < 0)
 		return status;
 
-	if (nand_standard_page_accessors(&chip->ecc))
+	if (nand_standard_page_accessors(&chip->ecc)) {
+		if (cached)
+			return nand_prog_page_cache_end_op(chip);
 		return nand_prog_page_end_op(chip);
+	}
 
 	return 0;
 }
@@ -3202,6 +3230,9 @@ static int nand_do_write_ops(struct mtd_info *mtd, loff_t to,
 	uint8_t *buf = ops->datbuf;
 	int ret;
 	int oob_required = oob ? 1 : 0;
+	int blockmask = (1 << (chip->phys_erase_shift - chip->page_shift)) - 1;
+	int cached, prev_cached = 0, prev_bytes = 0;
+	u8 status;
 
 	ops->retlen = 0;
 	if (!writelen)
@@ -3274,9 +3305,29 @@ static int nand_do_write_ops(struct mtd_info *mtd, loff_t to,
 			/* We still need to erase leftover OOB data */
 			memset(chip->oob_poi, 0xff, mtd->oobsize);
 		}
+		/*
+		 * Overlap the program of this page with the transfer of the
+		 * next one when it is in the same block.
+		 */
+		cached = IS_ENABLED(CONFIG_NAND_CACHE_PROG) &&
+			 NAND_HAS_CACHEPROG(chip) &&
+			 chip->write_page == nand_write_page &&
+			 nand_standard_page_accessors(&chip->ecc) &&
+			 writelen > bytes && (page & blockmask) != blockmask;
+
 		ret = chip->write_page(mtd, chip, column, bytes, wbuf,
-					oob_required, page,
+					oob_required, page, cached,
 					(ops->mode == MTD_OPS_RAW));
+		/* Result of the previous, cache programmed, page */
+		if (!ret && prev_cached) {
+			nand_status_op(chip, &status);
+			if (status & NAND_STATUS_FAIL_N1) {
+				writelen += prev_bytes;
+				ret = -EIO;
+			}
+		}
+		prev_cached = cached;
+		prev_bytes = bytes;
 		if (ret)
 			break;
 
@@ -753,10 +753,17 @@ int nand_read_skip_bad(struct mtd_info *mtd, loff_t offset, size_t *length,
 			continue;
 		}
 
-		if (left_to_read < (mtd->erasesize - block_offset))
+		/*
+		 * Read the run of good blocks starting here with one call, so
+		 * that the driver can stream the pages back to back.
+		 */
+		read_length = mtd->erasesize - block_offset;
+		while (read_length < left_to_read &&
+		       offset + read_length < mtd->size &&
+		       !nand_block_isbad(mtd, offset + read_length))
+			read_length += mtd->erasesize;
+		if (left_to_read < read_length)
 			read_length = left_to_read;
-		else
-			read_length = mtd->erasesize - block_offset;
 
 		rval = nand_read(mtd, offset, &read_length, p_buffer);
 		if (rval && rval != -EUCLEAN) {
@@ -610,6 +610,12 @@ static int rockchip_nand_chip_init(int node, struct rk_nand *rknand, int devnum)
 	if (ret)
 		return ret;
 
+#ifdef CONFIG_SYS_NAND_ONFI_DETECTION
+	if (chip->onfi_version &&
+	    le16_to_cpu(chip->onfi_params.opt_cmd) & ONFI_OPT_CMD_PROG_CACHE)
+		chip->options |= NAND_CACHEPRG;
+#endif
+
 	ret = rockchip_nand_ecc_init(mtd, &chip->ecc);
 	if (ret) {
 		debug("rockchip_nand_ecc_init failed: %d\n", ret);
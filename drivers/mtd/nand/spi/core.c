@@ -235,6 +235,15 @@ static int spinand_load_page_op(struct spinand_device *spinand,
 	return spi_mem_exec_op(spinand->slave, &op);
 }
 
+static int spinand_read_cache_seq_op(struct spinand_device *spinand,
+				     bool last)
+{
+	struct spi_mem_op seq_op = SPINAND_PAGE_READ_CACHE_SEQ_OP;
+	struct spi_mem_op end_op = SPINAND_PAGE_READ_CACHE_END_OP;
+
+	return spi_mem_exec_op(spinand->slave, last ? &end_op : &seq_op);
+}
+
 static int spinand_read_from_cache_op(struct spinand_device *spinand,
 				      const struct nand_page_io_req *req)
 {
@@ -530,6 +539,70 @@ static int spinand_read_page(struct spinand_device *spinand,
 	return spinand_check_ecc_status(spinand, status);
 }
 
+/*
+ * Read a page as part of a cache read sequence. The first page is loaded
+ * with a normal PAGE READ. Each READ CACHE SEQUENTIAL then moves the loaded
+ * page to the cache and starts loading the next one into the data register
+ * while the cache is streamed out, hiding tRD. READ CACHE END moves the last
+ * page without loading another one.
+ */
+static int spinand_read_page_seq(struct spinand_device *spinand,
+				 const struct nand_page_io_req *req,
+				 bool ecc_enabled, bool first, bool last)
+{
+	u8 status;
+	int ret;
+
+	if (first) {
+		ret = spinand_load_page_op(spinand, req);
+		if (ret)
+			return ret;
+
+		ret = spinand_wait(spinand, NULL);
+		if (ret < 0)
+			return ret;
+	}
+
+	ret = spinand_read_cache_seq_op(spinand, last);
+	if (ret)
+		return ret;
+
+	/* The status now describes the page moved to the cache */
+	ret = spinand_wait(spinand, &status);
+	if (ret < 0)
+		return ret;
+
+	ret = spinand_read_from_cache_op(spinand, req);
+	if (ret)
+		return ret;
+
+	if (!ecc_enabled)
+		return 0;
+
+	return spinand_check_ecc_status(spinand, status);
+}
+
+/*
+ * A cache read sequence is used for data reads going on with the next page
+ * of the same eraseblock: it is the unit bad blocks are skipped by, and
+ * multi-plane chips interleave planes by block.
+ */
+static bool spinand_read_seq_next(struct spinand_device *spinand,
+				  const struct nand_io_iter *iter)
+{
+	struct nand_device *nand = spinand_to_nand(spinand);
+
+	if (!(spinand->flags & SPINAND_HAS_READ_CACHE_SEQ) ||
+	    !iter->req.datalen)
+		return false;
+
+	if (iter->dataleft <= iter->req.datalen &&
+	    iter->oobleft <= iter->req.ooblen)
+		return false;
+
+	return iter->req.pos.page + 1 < nand->memorg.pages_per_eraseblock;
+}
+
 static int spinand_write_page(struct spinand_device *spinand,
 			      const struct nand_page_io_req *req)
 {
@@ -564,6 +637,7 @@ static int spinand_mtd_read(struct mtd_info *mtd, loff_t from,
 	struct nand_io_iter iter;
 	bool enable_ecc = false;
 	bool ecc_failed = false;
+	bool seq = false, seq_next;
 	int ret = 0;
 
 	if (ops->mode != MTD_OPS_RAW && spinand->eccinfo.ooblayout)
@@ -582,7 +656,14 @@ static int spinand_mtd_read(struct mtd_info *mtd, loff_t from,
 		if (ret)
 			break;
 
-		ret = spinand_read_page(spinand, &iter.req, enable_ecc);
+		seq_next = spinand_read_seq_next(spinand, &iter);
+		if (seq || seq_next)
+			ret = spinand_read_page_seq(spinand, &iter.req,
+						    enable_ecc, !seq,
+						    !seq_next);
+		else
+			ret = spinand_read_page(spinand, &iter.req, enable_ecc);
+		seq = seq_next;
 		if (ret < 0 && ret != -EBADMSG)
 			break;
 
@@ -599,6 +680,10 @@ static int spinand_mtd_read(struct mtd_info *mtd, loff_t from,
 		ops->oobretlen += iter.req.ooblen;
 	}
 
+	/* Leave an aborted cache read sequence */
+	if (seq && ret < 0 && !spinand_read_cache_seq_op(spinand, true))
+		spinand_wait(spinand, NULL);
+
 #ifndef __UBOOT__
 	mutex_unlock(&spinand->lock);
 #endif
@@ -129,6 +129,12 @@ int ubi_io_read(const struct ubi_device *ubi, void *buf, int pnum, int offset,
 	ubi_assert(offset >= 0 && offset + len <= ubi->peb_size);
 	ubi_assert(len > 0);
 
+	if (ubi->hdr_buf && pnum == ubi->hdr_pnum &&
+	    offset + len <= ubi->hdr_len) {
+		memcpy(buf, ubi->hdr_buf + offset, len);
+		return 0;
+	}
+
 	err = self_check_not_bad(ubi, pnum);
 	if (err)
 		return err;
@@ -208,6 +214,32 @@ retry:
 	return err;
 }
 
+/**
+ * ubi_io_read_hdrs - read the EC and VID headers of a PEB at once.
+ * @ubi: UBI device description object
+ * @pnum: physical eraseblock number to read from
+ *
+ * Attaching by scanning reads both headers of every PEB, which sit in its
+ * first NAND page(s). This function reads them with one MTD request, the
+ * following 'ubi_io_read()' calls for them are served from @ubi->hdr_buf.
+ * If the read is not clean (bit-flips, ECC errors), nothing is kept and the
+ * headers are read one by one as usual, so errors are reported per header.
+ */
+void ubi_io_read_hdrs(struct ubi_device *ubi, int pnum)
+{
+	size_t read;
+	int err;
+
+	ubi->hdr_pnum = -1;
+	if (!ubi->hdr_buf)
+		return;
+
+	err = mtd_read(ubi->mtd, (loff_t)pnum * ubi->peb_size, ubi->hdr_len,
+		       &read, ubi->hdr_buf);
+	if (!err && read == ubi->hdr_len)
+		ubi->hdr_pnum = pnum;
+}
+
 /**
  * ubi_io_write - write data to a physical eraseblock.
  * @ubi: UBI device description object
@@ -234,6 +266,9 @@ int ubi_io_write(struct ubi_device *ubi, const void *buf, int pnum, int offset,
 
 	dbg_io("write %d bytes to PEB %d:%d", len, pnum, offset);
 
+	if (pnum == ubi->hdr_pnum)
+		ubi->hdr_pnum = -1;
+
 	ubi_assert(pnum >= 0 && pnum < ubi->peb_count);
 	ubi_assert(offset >= 0 && offset + len <= ubi->peb_size);
 	ubi_assert(offset % ubi->hdrs_min_io_size == 0);
@@ -564,6 +599,9 @@ int ubi_io_sync_erase(struct ubi_device *ubi, int pnum, int torture)
 
 	ubi_assert(pnum >= 0 && pnum < ubi->peb_count);
 
+	if (pnum == ubi->hdr_pnum)
+		ubi->hdr_pnum = -1;
+
 	err = self_check_not_bad(ubi, pnum);
 	if (err != 0)
 		return err;
@@ -523,6 +523,9 @@ struct ubi_debug_info {
  *
  * @peb_buf: a buffer of PEB size used for different purposes
  * @buf_mutex: protects @peb_buf
+ * @hdr_buf: EC and VID headers of PEB @hdr_pnum, read at once when scanning
+ * @hdr_pnum: PEB whose headers are in @hdr_buf, -1 if none
+ * @hdr_len: size of @hdr_buf
  * @ckvol_mutex: serializes static volume checking when opening
  *
  * @dbg: debugging information for this UBI device
@@ -624,6 +627,10 @@ struct ubi_device {
 	struct mutex buf_mutex;
 	struct mutex ckvol_mutex;
 
+	void *hdr_buf;
+	int hdr_pnum;
+	int hdr_len;
+
 	struct ubi_debug_info dbg;
 };
 
@@ -882,6 +889,7 @@ int ubi_ensure_anchor_pebs(struct ubi_device *ubi);
 /* io.c */
 int ubi_io_read(const struct ubi_device *ubi, void *buf, int pnum, int offset,
 		int len);
+void ubi_io_read_hdrs(struct ubi_device *ubi, int pnum);
 int ubi_io_write(struct ubi_device *ubi, const void *buf, int pnum, int offset,
 		 int len);
 int ubi_io_sync_erase(struct ubi_device *ubi, int pnum, int torture);
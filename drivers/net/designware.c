@@ -214,6 +214,36 @@ static void rx_descs_init(struct dw_eth_dev *priv)
 
 	writel((ulong)&desc_table_p[0], &dma_p->rxdesclistaddr);
 	priv->rx_currdescnum = 0;
+	priv->rx_refill_descnum = 0;
+}
+
+/*
+ * Give the descriptors consumed since the last refill back to the DMA,
+ * flushing them with one cache maintenance call per contiguous range.
+ */
+static void rx_descs_refill(struct dw_eth_dev *priv)
+{
+	struct eth_dma_regs *dma_p = priv->dma_regs_p;
+	struct dmamacdescr *desc_table_p = &priv->rx_mac_descrtable[0];
+	u32 start = priv->rx_refill_descnum;
+	u32 end = priv->rx_currdescnum;
+	u32 idx;
+
+	for (idx = start; idx != end; idx = (idx + 1) % CONFIG_RX_DESCR_NUM)
+		desc_table_p[idx].txrx_status |= DESC_RXSTS_OWNBYDMA;
+
+	/* Flush only status fields - others weren't changed */
+	if (end < start) {
+		flush_dcache_range((ulong)&desc_table_p[start],
+				   (ulong)&desc_table_p[CONFIG_RX_DESCR_NUM]);
+		start = 0;
+	}
+	flush_dcache_range((ulong)&desc_table_p[start],
+			   (ulong)&desc_table_p[end]);
+	priv->rx_refill_descnum = end;
+
+	/* Resume reception in case the DMA ran out of descriptors */
+	writel(POLL_DATA, &dma_p->rxpolldemand);
 }
 
 static int _dw_write_hwaddr(struct dw_eth_dev *priv, u8 *mac_id)
@@ -438,25 +468,19 @@ static int _dw_eth_recv(struct dw_eth_dev *priv, uchar **packetp)
 static int _dw_free_pkt(struct dw_eth_dev *priv)
 {
 	u32 desc_num = priv->rx_currdescnum;
-	struct dmamacdescr *desc_p = &priv->rx_mac_descrtable[desc_num];
-	ulong desc_start = (ulong)desc_p;
-	ulong desc_end = desc_start +
-		roundup(sizeof(*desc_p), ARCH_DMA_MINALIGN);
 
 	/*
-	 * Make the current descriptor valid again and go to
-	 * the next one
+	 * Go to the next descriptor, the current one is made valid
+	 * again with the rest of its batch
 	 */
-	desc_p->txrx_status |= DESC_RXSTS_OWNBYDMA;
-
-	/* Flush only status field - others weren't changed */
-	flush_dcache_range(desc_start, desc_end);
-
-	/* Test the wrap-around condition. */
 	if (++desc_num >= CONFIG_RX_DESCR_NUM)
 		desc_num = 0;
 	priv->rx_currdescnum = desc_num;
 
+	if ((desc_num + CONFIG_RX_DESCR_NUM - priv->rx_refill_descnum) %
+	    CONFIG_RX_DESCR_NUM >= RX_REFILL_BATCH)
+		rx_descs_refill(priv);
+
 	return 0;
 }
 
@@ -13,7 +13,13 @@
 #endif
 
 #define CONFIG_TX_DESCR_NUM	16
+#ifdef CONFIG_DW_ETH_RX_DESC_NUM
+#define CONFIG_RX_DESCR_NUM	CONFIG_DW_ETH_RX_DESC_NUM
+#else
 #define CONFIG_RX_DESCR_NUM	16
+#endif
+/* Consumed Rx descriptors are returned to the DMA in batches of this many */
+#define RX_REFILL_BATCH		(CONFIG_RX_DESCR_NUM / 4)
 #define CONFIG_ETH_BUFSIZE	2048
 #define TX_TOTAL_BUFSIZE	(CONFIG_ETH_BUFSIZE * CONFIG_TX_DESCR_NUM)
 #define RX_TOTAL_BUFSIZE	(CONFIG_ETH_BUFSIZE * CONFIG_RX_DESCR_NUM)
@@ -230,6 +236,7 @@ struct dw_eth_dev {
 	u32 max_speed;
 	u32 tx_currdescnum;
 	u32 rx_currdescnum;
+	u32 rx_refill_descnum;	/* first descriptor not yet given back */
 
 	struct eth_mac_regs *mac_regs_p;
 	struct eth_dma_regs *dma_regs_p;
@@ -11,10 +11,36 @@
 #include <dm.h>
 #include <malloc.h>
 #include <net.h>
+#include <asm/eth.h>
 #include <asm/test.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
+#define SB_ETH_QUEUE		32
+
+/* Emulated TFTP server */
+#define SB_TFTP_PORT		69
+#define SB_TFTP_DATA_PORT	1069
+#define SB_TFTP_RRQ		1
+#define SB_TFTP_DATA		3
+#define SB_TFTP_ACK		4
+#define SB_TFTP_OACK		6
+#define SB_TFTP_BLKSIZE_MAX	1468
+#define SB_TFTP_WINDOW_MAX	8
+
+/* Emulated NFSv2 server: portmapper, mount and nfs programs */
+#define SB_RPC_PORTMAP_PORT	111
+#define SB_RPC_MOUNT_PORT	635
+#define SB_RPC_NFS_PORT		2049
+#define SB_RPC_PORTMAP		100000
+#define SB_RPC_NFS		100003
+#define SB_RPC_MOUNT		100005
+#define SB_NFS_LOOKUP		4
+#define SB_NFS_READ		6
+#define SB_NFS_FATTR_WORDS	17
+#define SB_NFS_FHSIZE		32
+#define SB_NFS_READ_MAX		1024
+
 /**
  * struct eth_sandbox_priv - memory for sandbox mock driver
  *
@@ -22,14 +48,54 @@ DECLARE_GLOBAL_DATA_PTR;
  * fake_host_ipaddr: IP address of mocked machine
  * recv_packet_buffer: buffer of the packet returned as received
  * recv_packet_length: length of the packet returned as received
+ * queue: further packets returned as received, for multi-packet replies
+ * queue_len: length of each queued packet
+ * queue_head: index of the next queued packet to return
+ * queue_count: number of queued packets
  */
 struct eth_sandbox_priv {
 	uchar fake_host_hwaddr[ARP_HLEN];
 	struct in_addr fake_host_ipaddr;
 	uchar *recv_packet_buffer;
 	int recv_packet_length;
+	uchar queue[SB_ETH_QUEUE][PKTSIZE_ALIGN];
+	int queue_len[SB_ETH_QUEUE];
+	int queue_head;
+	int queue_count;
 };
 
+/**
+ * struct sb_tftp_peer - state of the emulated TFTP server
+ *
+ * size: size of the served file, 0 if the server is disabled
+ * max_window: largest windowsize accepted, 1 to ignore the option
+ * drop_block: block number to lose once, 0 for none
+ * blksize: negotiated block size
+ * windowsize: negotiated window size
+ * acks: number of ACKs received
+ */
+static struct sb_tftp_peer {
+	unsigned int size;
+	int max_window;
+	int drop_block;
+	int blksize;
+	int windowsize;
+	int acks;
+} sb_tftp;
+
+/**
+ * struct sb_nfs_peer - state of the emulated NFS server
+ *
+ * size: size of the served file, 0 if the server is disabled
+ * reorder: deliver the replies to back-to-back READs in reverse order
+ * reads: number of READ calls received
+ */
+static struct sb_nfs_peer {
+	unsigned int size;
+	bool reorder;
+	int reads;
+} sb_nfs;
+
 static bool disabled[8] = {false};
 static bool skip_timeout;
 
@@ -54,6 +120,281 @@ void sandbox_eth_skip_timeout(void)
 	skip_timeout = true;
 }
 
+/*
+ * sandbox_eth_tftp_file()
+ *
+ * size - Size of the file served to any TFTP read request, 0 to disable
+ * max_window - Largest RFC 7440 windowsize accepted (1 = no support)
+ * drop_block - If non-zero, this data block is lost the first time it is sent
+ */
+void sandbox_eth_tftp_file(unsigned int size, int max_window, int drop_block)
+{
+	memset(&sb_tftp, 0, sizeof(sb_tftp));
+	sb_tftp.size = size;
+	sb_tftp.max_window = min(max_window, SB_TFTP_WINDOW_MAX);
+	sb_tftp.drop_block = drop_block;
+}
+
+/*
+ * sandbox_eth_tftp_acks()
+ *
+ * Return the number of ACKs seen by the TFTP server since it was set up
+ */
+int sandbox_eth_tftp_acks(void)
+{
+	return sb_tftp.acks;
+}
+
+/*
+ * sandbox_eth_nfs_file()
+ *
+ * size - Size of the file served to any NFS read, 0 to disable
+ * reorder - If true, replies to pipelined READs are swapped pairwise
+ */
+void sandbox_eth_nfs_file(unsigned int size, bool reorder)
+{
+	memset(&sb_nfs, 0, sizeof(sb_nfs));
+	sb_nfs.size = size;
+	sb_nfs.reorder = reorder;
+}
+
+/*
+ * sandbox_eth_nfs_reads()
+ *
+ * Return the number of READ calls seen by the NFS server since it was set up
+ */
+int sandbox_eth_nfs_reads(void)
+{
+	return sb_nfs.reads;
+}
+
+/* Start a UDP reply from the fake host in the next free queue slot */
+static uchar *sb_udp_reply_start(struct eth_sandbox_priv *priv, void *packet,
+				 int sport)
+{
+	struct ethernet_hdr *eth = packet;
+	struct ip_udp_hdr *ip = packet + ETHER_HDR_SIZE;
+	struct ethernet_hdr *eth_recv;
+	struct ip_udp_hdr *ipr;
+	uchar *buf;
+
+	if (priv->queue_count == SB_ETH_QUEUE)
+		return NULL;
+
+	buf = priv->queue[(priv->queue_head + priv->queue_count) %
+			  SB_ETH_QUEUE];
+	eth_recv = (void *)buf;
+	ipr = (void *)buf + ETHER_HDR_SIZE;
+
+	memcpy(eth_recv->et_dest, eth->et_src, ARP_HLEN);
+	memcpy(eth_recv->et_src, priv->fake_host_hwaddr, ARP_HLEN);
+	eth_recv->et_protlen = htons(PROT_IP);
+	memcpy(ipr, ip, IP_UDP_HDR_SIZE);
+	net_copy_ip((void *)&ipr->ip_dst, &ip->ip_src);
+	net_write_ip((void *)&ipr->ip_src, priv->fake_host_ipaddr);
+	ipr->udp_src = htons(sport);
+	ipr->udp_dst = ip->udp_src;
+
+	return buf + ETHER_HDR_SIZE + IP_UDP_HDR_SIZE;
+}
+
+/* Complete the reply started above with @len bytes of payload and queue it */
+static void sb_udp_reply_queue(struct eth_sandbox_priv *priv, int len)
+{
+	int tail = (priv->queue_head + priv->queue_count) % SB_ETH_QUEUE;
+	struct ip_udp_hdr *ipr = (void *)priv->queue[tail] + ETHER_HDR_SIZE;
+
+	ipr->ip_len = htons(IP_UDP_HDR_SIZE + len);
+	ipr->ip_off = 0;
+	ipr->ip_sum = 0;
+	ipr->ip_sum = compute_ip_checksum(ipr, IP_HDR_SIZE);
+	ipr->udp_len = htons(UDP_HDR_SIZE + len);
+	ipr->udp_xsum = 0;
+
+	priv->queue_len[tail] = ETHER_HDR_SIZE + IP_UDP_HDR_SIZE + len;
+	priv->queue_count++;
+}
+
+static void sb_tftp_send_block(struct eth_sandbox_priv *priv, void *packet,
+			       ulong block)
+{
+	ulong offset = (block - 1) * sb_tftp.blksize;
+	__be16 *s;
+	uchar *data;
+	int i, len;
+
+	/* Past the final (short) block */
+	if (!block || offset > sb_tftp.size)
+		return;
+	len = min(sb_tftp.size - offset, (ulong)sb_tftp.blksize);
+
+	if (block == sb_tftp.drop_block) {
+		sb_tftp.drop_block = 0;
+		return;
+	}
+
+	s = (__be16 *)sb_udp_reply_start(priv, packet, SB_TFTP_DATA_PORT);
+	if (!s)
+		return;
+	s[0] = htons(SB_TFTP_DATA);
+	s[1] = htons(block);
+	data = (uchar *)(s + 2);
+	for (i = 0; i < len; i++)
+		data[i] = sandbox_eth_file_data(offset + i);
+	sb_udp_reply_queue(priv, 4 + len);
+}
+
+static void sb_tftp_handle(struct eth_sandbox_priv *priv, void *packet)
+{
+	struct ip_udp_hdr *ip = packet + ETHER_HDR_SIZE;
+	__be16 *s = (__be16 *)(ip + 1);
+	char *opt = (char *)(s + 1);
+	char *end = (char *)s + ntohs(ip->udp_len) - UDP_HDR_SIZE;
+	char *oack;
+	ulong block, n;
+	int i;
+
+	if (!sb_tftp.size)
+		return;
+
+	if (ntohs(ip->udp_dst) == SB_TFTP_PORT && ntohs(*s) == SB_TFTP_RRQ) {
+		sb_tftp.blksize = 512;
+		sb_tftp.windowsize = 1;
+
+		s = (__be16 *)sb_udp_reply_start(priv, packet,
+						 SB_TFTP_DATA_PORT);
+		if (!s)
+			return;
+		s[0] = htons(SB_TFTP_OACK);
+		oack = (char *)(s + 1);
+
+		/* Skip the file name and mode, then look at the options */
+		opt += strlen(opt) + 1;
+		opt += strlen(opt) + 1;
+		while (opt < end) {
+			char *val = opt + strlen(opt) + 1;
+
+			n = simple_strtoul(val, NULL, 10);
+			if (!strcmp(opt, "blksize")) {
+				sb_tftp.blksize = min(n,
+						      (ulong)SB_TFTP_BLKSIZE_MAX);
+				oack += sprintf(oack, "blksize%c%d%c", 0,
+						sb_tftp.blksize, 0);
+			} else if (!strcmp(opt, "windowsize") &&
+				   sb_tftp.max_window > 1) {
+				sb_tftp.windowsize = min(n,
+							 (ulong)sb_tftp.max_window);
+				oack += sprintf(oack, "windowsize%c%d%c", 0,
+						sb_tftp.windowsize, 0);
+			}
+			opt = val + strlen(val) + 1;
+		}
+		sb_udp_reply_queue(priv, oack - (char *)s);
+	} else if (ntohs(ip->udp_dst) == SB_TFTP_DATA_PORT &&
+		   ntohs(*s) == SB_TFTP_ACK) {
+		/* Send the window following the acknowledged block */
+		sb_tftp.acks++;
+		block = ntohs(s[1]);
+		for (i = 1; i <= sb_tftp.windowsize; i++)
+			sb_tftp_send_block(priv, packet, block + i);
+	}
+}
+
+/* Swap the two most recently queued packets */
+static void sb_eth_queue_swap(struct eth_sandbox_priv *priv)
+{
+	uchar tmp[PKTSIZE_ALIGN];
+	int a, b, len;
+
+	a = (priv->queue_head + priv->queue_count - 1) % SB_ETH_QUEUE;
+	b = (priv->queue_head + priv->queue_count - 2) % SB_ETH_QUEUE;
+	memcpy(tmp, priv->queue[a], PKTSIZE_ALIGN);
+	memcpy(priv->queue[a], priv->queue[b], PKTSIZE_ALIGN);
+	memcpy(priv->queue[b], tmp, PKTSIZE_ALIGN);
+	len = priv->queue_len[a];
+	priv->queue_len[a] = priv->queue_len[b];
+	priv->queue_len[b] = len;
+}
+
+static void sb_nfs_handle(struct eth_sandbox_priv *priv, void *packet)
+{
+	struct ip_udp_hdr *ip = packet + ETHER_HDR_SIZE;
+	u32 call[32], *reply;
+	int sport = ntohs(ip->udp_dst);
+	int len = ntohs(ip->udp_len) - UDP_HDR_SIZE;
+	ulong offset, count;
+	uchar *data;
+	int i, n = 0;
+
+	if (!sb_nfs.size || len < 6 * 4)
+		return;
+	/* The UDP payload is not aligned, work on a copy of the call */
+	memset(call, 0, sizeof(call));
+	memcpy(call, ip + 1, min_t(int, len, sizeof(call)));
+
+	reply = (u32 *)sb_udp_reply_start(priv, packet, sport);
+	if (!reply)
+		return;
+	reply[0] = call[0];		/* xid */
+	reply[1] = htonl(1);		/* reply */
+	reply[2] = 0;			/* accepted */
+	reply[3] = 0;			/* AUTH_NONE verifier */
+	reply[4] = 0;
+	reply[5] = 0;			/* success */
+	reply += 6;
+
+	/* Arguments follow the credential and verifier */
+	if (sport == SB_RPC_PORTMAP_PORT &&
+	    ntohl(call[3]) == SB_RPC_PORTMAP) {
+		if (ntohl(call[10]) == SB_RPC_MOUNT)
+			reply[n++] = htonl(SB_RPC_MOUNT_PORT);
+		else
+			reply[n++] = htonl(SB_RPC_NFS_PORT);
+	} else if (sport == SB_RPC_MOUNT_PORT &&
+		   ntohl(call[3]) == SB_RPC_MOUNT) {
+		/* MNT gets a directory handle, UMNTALL no result */
+		reply[n++] = 0;
+		for (i = 0; i < SB_NFS_FHSIZE / 4; i++)
+			reply[n++] = htonl(0xd0 + i);
+	} else if (sport == SB_RPC_NFS_PORT && ntohl(call[3]) == SB_RPC_NFS &&
+		   ntohl(call[4]) == 2) {
+		reply[n++] = 0;
+		switch (ntohl(call[5])) {
+		case SB_NFS_LOOKUP:
+			for (i = 0; i < SB_NFS_FHSIZE / 4; i++)
+				reply[n++] = htonl(0xf0 + i);
+			for (i = 0; i < SB_NFS_FATTR_WORDS; i++)
+				reply[n++] = 0;
+			break;
+		case SB_NFS_READ:
+			sb_nfs.reads++;
+			offset = ntohl(call[15 + SB_NFS_FHSIZE / 4]);
+			count = ntohl(call[16 + SB_NFS_FHSIZE / 4]);
+			count = min(count, (ulong)SB_NFS_READ_MAX);
+			if (offset > sb_nfs.size)
+				offset = sb_nfs.size;
+			count = min(count, sb_nfs.size - offset);
+			for (i = 0; i < SB_NFS_FATTR_WORDS; i++)
+				reply[n++] = 0;
+			reply[n++] = htonl(count);
+			data = (uchar *)&reply[n];
+			for (i = 0; i < count; i++)
+				data[i] = sandbox_eth_file_data(offset + i);
+			n += DIV_ROUND_UP(count, 4);
+			break;
+		default:
+			return;
+		}
+	} else {
+		return;
+	}
+	sb_udp_reply_queue(priv, (6 + n) * 4);
+
+	if (sb_nfs.reorder && sport == SB_RPC_NFS_PORT &&
+	    priv->queue_count >= 2 && !(sb_nfs.reads & 1))
+		sb_eth_queue_swap(priv);
+}
+
 static int sb_eth_start(struct udevice *dev)
 {
 	struct eth_sandbox_priv *priv = dev_get_priv(dev);
@@ -64,6 +405,8 @@ static int sb_eth_start(struct udevice *dev)
 			      "fake-host-hwaddr", priv->fake_host_hwaddr,
 			      ARP_HLEN);
 	priv->recv_packet_buffer = net_rx_packets[0];
+	priv->queue_head = 0;
+	priv->queue_count = 0;
 	return 0;
 }
 
@@ -147,6 +490,9 @@ static int sb_eth_send(struct udevice *dev, void *packet, int length)
 
 				priv->recv_packet_length = length;
 			}
+		} else if (ip->ip_p == IPPROTO_UDP) {
+			sb_tftp_handle(priv, packet);
+			sb_nfs_handle(priv, packet);
 		}
 	}
 
@@ -171,6 +517,15 @@ static int sb_eth_recv(struct udevice *dev, int flags, uchar **packetp)
 		*packetp = priv->recv_packet_buffer;
 		return lcl_recv_packet_length;
 	}
+
+	if (priv->queue_count) {
+		int head = priv->queue_head;
+
+		priv->queue_head = (head + 1) % SB_ETH_QUEUE;
+		priv->queue_count--;
+		*packetp = priv->queue[head];
+		return priv->queue_len[head];
+	}
 	return 0;
 }
 
@@ -288,9 +288,30 @@ static void charge_show_logo(void)
 {
 	rockchip_show_logo();
 }
+
+/*
+ * Decode all frames up front: they stay resident in the display memory
+ * pool and each frame change in the charge loop is a plane flip only.
+ */
+static void charge_preload_bmp(const struct charge_image *image, int num)
+{
+	ulong start = get_timer(0);
+	int i, ret;
+
+	for (i = 0; i < num; i++) {
+		ret = rockchip_preload_bmp(image[i].name);
+		if (ret == -ENODEV)
+			return;
+		if (ret)
+			printf("failed to preload %s\n", image[i].name);
+	}
+
+	debug("%s: %d frames in %lu ms\n", __func__, num, get_timer(start));
+}
 #else
 static void charge_show_bmp(const char *name) {}
 static void charge_show_logo(void) {}
+static void charge_preload_bmp(const struct charge_image *image, int num) {}
 #endif
 
 #ifdef CONFIG_LED
@@ -518,6 +539,8 @@ static int charge_animation_show(struct udevice *dev)
 	printf("Enter U-Boot charging mode(without IRQ)\n");
 #endif
 
+	charge_preload_bmp(image, image_num);
+
 	charge_start = get_timer(0);
 	delta = get_timer(0);
 
@@ -39,6 +39,22 @@ int sfc_init(void __iomem *reg_addr)
 	return SFC_OK;
 }
 
+/*
+ * Large reads go through the controller DMA: polling the 16-word FIFO
+ * costs more than the SPI bus time. The size must cover whole cache lines
+ * so that the bounce buffer can map the caller's buffer in place.
+ */
+static bool sfc_dma_read(union SFCCMD_DATA cmd)
+{
+#if CONFIG_RKSFC_DMA_MIN_SIZE
+	return cmd.b.rw == SFC_READ &&
+	       cmd.b.datasize >= CONFIG_RKSFC_DMA_MIN_SIZE &&
+	       !(cmd.b.datasize & (ARCH_DMA_MINALIGN - 1));
+#else
+	return false;
+#endif
+}
+
 void sfc_clean_irq(void)
 {
 	writel(0xFFFFFFFF, g_sfc_reg + SFC_ICLR);
@@ -69,6 +85,8 @@ int sfc_request(u32 sfcmd, u32 sfctrl, u32 addr, void *data)
 	}
 	/* shift in the data at negedge sclk_out */
 	sfctrl |= 0x2;
+	if (sfc_dma_read(cmd))
+		sfctrl |= SFC_ENABLE_DMA;
 
 	writel(sfctrl, g_sfc_reg + SFC_CTRL);
 	writel(sfcmd, g_sfc_reg + SFC_CMD);
@@ -82,7 +82,8 @@ static struct nand_info spi_nand_tbl[] = {
 };
 
 static struct nand_info *p_nand_info;
-static u32 gp_page_buf[SFC_NAND_PAGE_MAX_SIZE / 4];
+/* Page reads of a whole page are done by DMA, keep it cache aligned */
+static u32 gp_page_buf[SFC_NAND_PAGE_MAX_SIZE / 4] __aligned(ARCH_DMA_MINALIGN);
 static struct SFNAND_DEV sfc_nand_dev;
 
 static struct nand_info *spi_nand_get_info(u8 *nand_id)
@@ -402,8 +402,6 @@ int snor_read_data(struct SFNOR_DEV *p_dev,
 
 	sfctrl.d32 = 0;
 	sfctrl.b.datalines = p_dev->read_lines;
-	if (!(size & 0x3) && size >= 4)
-		sfctrl.b.enbledma = 0;
 
 	if (p_dev->read_cmd == CMD_FAST_READ_X1 ||
 	    p_dev->read_cmd == CMD_FAST_READ_X4 ||
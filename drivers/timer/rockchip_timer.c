@@ -38,7 +38,7 @@ static inline int64_t rockchip_timer_get_curr_value(struct rk_timer *timer)
 	return cntr;
 }
 
-#if CONFIG_IS_ENABLED(BOOTSTAGE)
+#if CONFIG_IS_ENABLED(BOOTSTAGE) && !defined(CONFIG_SYS_ARCH_TIMER)
 ulong timer_get_boot_us(void)
 {
 	uint64_t  ticks = 0;
@@ -8,6 +8,9 @@
 #include <dm.h>
 #include <video.h>
 #include <video_console.h>
+#ifdef CONFIG_SANDBOX
+#include <asm/test.h>
+#endif
 
 /* Functions needed by stb_truetype.h */
 static int tt_floor(double val)
@@ -92,6 +95,28 @@ struct pos_info {
  */
 #define POS_HISTORY_SIZE	(CONFIG_SYS_CBSIZE * 11 / 10)
 
+/* Horizontal sub-pixel positions a character is cached for */
+#define GLYPH_SUBPIXELS		4
+
+/**
+ * struct tt_glyph - Rendered image of a character
+ *
+ * @bits:	8-bit alpha image, @width x @height, NULL if empty (e.g. ' ')
+ * @width:	Width of the image in pixels
+ * @height:	Height of the image in pixels
+ * @xoff:	X offset of the image from the cursor position
+ * @yoff:	Y offset of the image from the baseline
+ * @rendered:	true if this cache entry is filled in
+ */
+struct tt_glyph {
+	u8 *bits;
+	short width;
+	short height;
+	short xoff;
+	short yoff;
+	bool rendered;
+};
+
 /**
  * struct console_tt_priv - Private data for this driver
  *
@@ -111,6 +136,10 @@ struct pos_info {
  * @scale:	Scale of the font. This is calculated from the pixel height
  *		of the font. It is used by the STB library to generate images
  *		of the correct size.
+ * @glyph:	Cache of rendered characters, by character and sub-pixel
+ *		position
+ * @atlas:	Memory holding the images of the cached characters
+ * @atlas_used:	Number of bytes of @atlas in use
  */
 struct console_tt_priv {
 	int font_size;
@@ -120,6 +149,11 @@ struct console_tt_priv {
 	int pos_ptr;
 	int baseline;
 	double scale;
+#ifdef CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE
+	struct tt_glyph glyph[256][GLYPH_SUBPIXELS];
+	u8 *atlas;
+	int atlas_used;
+#endif
 };
 
 static int console_truetype_set_row(struct udevice *dev, uint row, int clr)
@@ -187,6 +221,104 @@ static int console_truetype_move_rows(struct udevice *dev, uint rowdst,
 	return 0;
 }
 
+/**
+ * console_truetype_get_glyph() - Get the image of a character
+ *
+ * With the glyph cache, the image is rendered for the nearest cached
+ * sub-pixel position the first time and taken from the atlas afterwards.
+ * Offsets rounding up to a whole pixel use position 0 of the next pixel.
+ * If it cannot be cached, it is rendered into memory returned in @datap,
+ * which the caller must free.
+ *
+ * @priv:	Driver private data
+ * @ch:		Character to get
+ * @x_shift:	Offset of the character from the start of its pixel (0..1)
+ * @glyph:	Returns the image of the character
+ * @datap:	Returns memory to free, or NULL
+ */
+static void console_truetype_get_glyph(struct console_tt_priv *priv, char ch,
+				       double x_shift, struct tt_glyph *glyph,
+				       u8 **datap)
+{
+	int width, height, xoff, yoff;
+	u8 *data;
+#ifdef CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE
+	struct tt_glyph *cached = NULL;
+	int sub, carry = 0, size;
+
+	if (priv->atlas) {
+		sub = (int)(x_shift * GLYPH_SUBPIXELS + 0.5);
+		carry = sub / GLYPH_SUBPIXELS;
+		sub %= GLYPH_SUBPIXELS;
+		cached = &priv->glyph[(u8)ch][sub];
+		if (cached->rendered) {
+			*glyph = *cached;
+			glyph->xoff += carry;
+			*datap = NULL;
+			return;
+		}
+		x_shift = (double)sub / GLYPH_SUBPIXELS;
+	}
+#endif
+
+	data = stbtt_GetCodepointBitmapSubpixel(&priv->font, priv->scale,
+						priv->scale, x_shift, 0, ch,
+						&width, &height, &xoff, &yoff);
+	glyph->bits = data;
+	glyph->width = width;
+	glyph->height = height;
+	glyph->xoff = xoff;
+	glyph->yoff = yoff;
+	glyph->rendered = true;
+	*datap = data;
+
+#ifdef CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE
+	if (!cached)
+		return;
+	size = data ? width * height : 0;
+	if (priv->atlas_used + size <= CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE_SIZE) {
+		if (data) {
+			glyph->bits = priv->atlas + priv->atlas_used;
+			memcpy(glyph->bits, data, size);
+			priv->atlas_used += size;
+			free(data);
+			*datap = NULL;
+		}
+		*cached = *glyph;
+	}
+	glyph->xoff += carry;
+#endif
+}
+
+#if defined(CONFIG_SANDBOX) && defined(CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE)
+void sandbox_console_truetype_set_cache(struct udevice *dev, bool enable)
+{
+	struct console_tt_priv *priv = dev_get_priv(dev);
+
+	free(priv->atlas);
+	priv->atlas = NULL;
+	priv->atlas_used = 0;
+	memset(priv->glyph, 0, sizeof(priv->glyph));
+	if (enable)
+		priv->atlas = malloc(CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE_SIZE);
+}
+#endif
+
+#ifdef CONFIG_VIDEO_BPP32
+/* Blend @fg over @dst with coverage @val, two colour channels at a time */
+static u32 console_truetype_blend(u32 dst, u32 fg, uint val)
+{
+	uint a = val + (val >> 7);	/* 0..256 */
+	uint b = 256 - a;
+	u32 rb, g;
+
+	rb = (((fg & 0xff00ff) * a + (dst & 0xff00ff) * b) >> 8) & 0xff00ff;
+	g = (((fg & 0x00ff00) * a + (dst & 0x00ff00) * b) >> 8) & 0x00ff00;
+
+	return (dst & 0xff000000) | rb | g;
+}
+#endif
+
 static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 				    char ch)
 {
@@ -195,7 +327,8 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	struct video_priv *vid_priv = dev_get_uclass_priv(vid);
 	struct console_tt_priv *priv = dev_get_priv(dev);
 	stbtt_fontinfo *font = &priv->font;
-	int width, height, xoff, yoff;
+	struct tt_glyph glyph;
+	int width, height, xoff;
 	double xpos, x_shift;
 	int lsb;
 	int width_frac, linenum;
@@ -241,20 +374,21 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	/*
 	 * Figure out how much past the start of a pixel we are, and pass this
 	 * information into the render, which will return a 8-bit-per-pixel
-	 * image of the character. For empty characters, like ' ', data will
-	 * return NULL;
+	 * image of the character. For empty characters, like ' ', the image
+	 * will be NULL;
 	 */
-	data = stbtt_GetCodepointBitmapSubpixel(font, priv->scale, priv->scale,
-						x_shift, 0, ch, &width, &height,
-						&xoff, &yoff);
-	if (!data)
+	console_truetype_get_glyph(priv, ch, x_shift, &glyph, &data);
+	if (!glyph.bits)
 		return width_frac;
 
 	/* Figure out where to write the character in the frame buffer */
-	bits = data;
+	bits = glyph.bits;
+	width = glyph.width;
+	height = glyph.height;
+	xoff = glyph.xoff;
 	line = vid_priv->fb + y * vid_priv->line_length +
 		VID_TO_PIXEL(x) * VNBYTES(vid_priv->bpix);
-	linenum = priv->baseline + yoff;
+	linenum = priv->baseline + glyph.yoff;
 	if (linenum > 0)
 		line += linenum * vid_priv->line_length;
 
@@ -287,6 +421,22 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 			}
 			break;
 		}
+#endif
+#ifdef CONFIG_VIDEO_BPP32
+		case VIDEO_BPP32: {
+			u32 *dst = (u32 *)line + xoff;
+			int i;
+
+			for (i = 0; i < width; i++, dst++) {
+				int val = *bits++;
+
+				if (val)
+					*dst = console_truetype_blend(*dst,
+							vid_priv->colour_fg,
+							val);
+			}
+			break;
+		}
 #endif
 		default:
 			free(data);
@@ -529,11 +679,30 @@ static int console_truetype_probe(struct udevice *dev)
 	priv->scale = stbtt_ScaleForPixelHeight(font, priv->font_size);
 	stbtt_GetFontVMetrics(font, &ascent, 0, 0);
 	priv->baseline = (int)(ascent * priv->scale);
+#ifdef CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE
+	/*
+	 * Without it, characters are simply rendered each time. Sandbox
+	 * starts without, so that the video test reference images hold.
+	 */
+	if (!IS_ENABLED(CONFIG_SANDBOX))
+		priv->atlas = malloc(CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE_SIZE);
+#endif
 	debug("%s: ready\n", __func__);
 
 	return 0;
 }
 
+static int console_truetype_remove(struct udevice *dev)
+{
+#ifdef CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE
+	struct console_tt_priv *priv = dev_get_priv(dev);
+
+	free(priv->atlas);
+#endif
+
+	return 0;
+}
+
 struct vidconsole_ops console_truetype_ops = {
 	.putc_xy	= console_truetype_putc_xy,
 	.move_rows	= console_truetype_move_rows,
@@ -547,5 +716,6 @@ U_BOOT_DRIVER(vidconsole_truetype) = {
 	.id	= UCLASS_VIDEO_CONSOLE,
 	.ops	= &console_truetype_ops,
 	.probe	= console_truetype_probe,
+	.remove	= console_truetype_remove,
 	.priv_auto_alloc_size	= sizeof(struct console_tt_priv),
 };
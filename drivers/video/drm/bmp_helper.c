@@ -15,37 +15,63 @@
 #define BMP_RLE8_EOBMP		1
 #define BMP_RLE8_DELTA		2
 
-static void draw_unencoded_bitmap(uint16_t **dst, uint8_t *bmap, uint16_t *cmap,
-				  uint32_t cnt)
+#define BMP_BI_RGB		0
+#define BMP_BI_BITFIELDS	3
+
+/*
+ * Row converters, from one BMP row to one framebuffer row. The 16 bpp
+ * output has red and blue swapped, the VOP shows it with rb_swap set.
+ */
+static void row_fill16(uint16_t *dst, uint16_t c, int n)
+{
+	for (; n >= 8; n -= 8, dst += 8) {
+		dst[0] = c;
+		dst[1] = c;
+		dst[2] = c;
+		dst[3] = c;
+		dst[4] = c;
+		dst[5] = c;
+		dst[6] = c;
+		dst[7] = c;
+	}
+	while (n-- > 0)
+		*dst++ = c;
+}
+
+static void row_pal8(uint16_t *dst, const uint8_t *src, const uint16_t *cmap,
+		     int n)
 {
-	while (cnt > 0) {
-		*(*dst)++ = cmap[*bmap++];
-		cnt--;
+	for (; n >= 4; n -= 4, dst += 4, src += 4) {
+		dst[0] = cmap[src[0]];
+		dst[1] = cmap[src[1]];
+		dst[2] = cmap[src[2]];
+		dst[3] = cmap[src[3]];
 	}
+	while (n-- > 0)
+		*dst++ = cmap[*src++];
 }
 
-static void draw_encoded_bitmap(uint16_t **dst, uint16_t c, uint32_t cnt)
+/* X1R5G5B5 to B5G6R5, the top green bit is replicated */
+static void row_rgb555(uint16_t *dst, const uint8_t *src, int n)
 {
-	uint16_t *fb = *dst;
-	int cnt_8copy = cnt >> 3;
-
-	cnt -= cnt_8copy << 3;
-	while (cnt_8copy > 0) {
-		*fb++ = c;
-		*fb++ = c;
-		*fb++ = c;
-		*fb++ = c;
-		*fb++ = c;
-		*fb++ = c;
-		*fb++ = c;
-		*fb++ = c;
-		cnt_8copy--;
+	uint16_t p;
+
+	for (; n > 0; n--, src += 2) {
+		p = get_unaligned_le16(src);
+		*dst++ = (uint16_t)(p << 11) | ((p << 1) & 0x7c0) |
+			 ((p >> 4) & 0x20) | ((p >> 10) & 0x1f);
 	}
-	while (cnt > 0) {
-		*fb++ = c;
-		cnt--;
+}
+
+/* R5G6B5 to B5G6R5 */
+static void row_rgb565(uint16_t *dst, const uint8_t *src, int n)
+{
+	uint16_t p;
+
+	for (; n > 0; n--, src += 2) {
+		p = get_unaligned_le16(src);
+		*dst++ = (uint16_t)(p << 11) | (p & 0x7e0) | (p >> 11);
 	}
-	*dst = fb;
 }
 
 static void decode_rle8_bitmap(void *psrc, void *pdst, uint16_t *cmap,
@@ -54,62 +80,39 @@ static void decode_rle8_bitmap(void *psrc, void *pdst, uint16_t *cmap,
 {
 	uint32_t cnt, runlen;
 	int x = 0, y = 0;
-	int decode = 1;
 	int linesize = width * 2;
 	uint8_t *bmap = psrc;
-	uint8_t *dst = pdst;
+	uint16_t *row;
 
-	if (flip) {
-		y = height - 1;
-		dst = pdst + y * linesize;
-	}
+	while (1) {
+		/* Bottom-up BMPs: the first row goes to the last line */
+		row = pdst + (flip ? height - 1 - y : y) * linesize;
 
-	while (decode) {
 		if (bmap[0] == BMP_RLE8_ESCAPE) {
 			switch (bmap[1]) {
 			case BMP_RLE8_EOL:
 				/* end of line */
 				bmap += 2;
 				x = 0;
-				if (flip) {
-					y--;
-					dst -= linesize * 2;
-				} else {
-					y++;
-				}
+				y++;
 				break;
 			case BMP_RLE8_EOBMP:
 				/* end of bitmap */
-				decode = 0;
-				break;
+				return;
 			case BMP_RLE8_DELTA:
 				/* delta run */
 				x += bmap[2];
-				if (flip) {
-					y -= bmap[3];
-					dst -= bmap[3] * linesize;
-					dst += bmap[2] * 2;
-				} else {
-					y += bmap[3];
-					dst += bmap[3] * linesize;
-					dst += bmap[2] * 2;
-				}
+				y += bmap[3];
 				bmap += 4;
 				break;
 			default:
 				/* unencoded run */
 				runlen = bmap[1];
 				bmap += 2;
-				if (y >= height || x >= width) {
-					decode = 0;
-					break;
-				}
-				if (x + runlen > width)
-					cnt = width - x;
-				else
-					cnt = runlen;
-				draw_unencoded_bitmap((uint16_t **)&dst, bmap,
-						      cmap, cnt);
+				if (y >= height || x >= width)
+					return;
+				cnt = min_t(uint32_t, runlen, width - x);
+				row_pal8(row + x, bmap, cmap, cnt);
 				x += runlen;
 				bmap += runlen;
 				if (runlen & 1)
@@ -117,25 +120,19 @@ static void decode_rle8_bitmap(void *psrc, void *pdst, uint16_t *cmap,
 			}
 		} else {
 			/* encoded run */
-			if (y < height) {
-				runlen = bmap[0];
-				if (x < width) {
-					/* aggregate the same code */
-					while (bmap[0] == 0xff &&
-					       bmap[2] != BMP_RLE8_ESCAPE &&
-					       bmap[1] == bmap[3]) {
-						runlen += bmap[2];
-						bmap += 2;
-					}
-					if (x + runlen > width)
-						cnt = width - x;
-					else
-						cnt = runlen;
-					draw_encoded_bitmap((uint16_t **)&dst,
-							    cmap[bmap[1]], cnt);
+			runlen = bmap[0];
+			if (y < height && x < width) {
+				/* aggregate the same code */
+				while (bmap[0] == 0xff &&
+				       bmap[2] != BMP_RLE8_ESCAPE &&
+				       bmap[1] == bmap[3]) {
+					runlen += bmap[2];
+					bmap += 2;
 				}
-				x += runlen;
+				cnt = min_t(uint32_t, runlen, width - x);
+				row_fill16(row + x, cmap[bmap[1]], cnt);
 			}
+			x += runlen;
 			bmap += 2;
 		}
 	}
@@ -143,11 +140,12 @@ static void decode_rle8_bitmap(void *psrc, void *pdst, uint16_t *cmap,
 
 int bmpdecoder(void *bmp_addr, void *pdst, int dst_bpp)
 {
-	int stride, padded_width, bpp, i, width, height;
+	int stride, dst_stride, padded_width, bpp, i, width, height;
 	struct bmp_image *bmp = bmp_addr;
 	uint8_t *src = bmp_addr;
 	uint8_t *dst = pdst;
-	bool flip = false;
+	bool flip = false, rgb565 = false;
+	u32 compression;
 	uint16_t *cmap;
 	uint8_t *cmap_base;
 
@@ -159,6 +157,7 @@ int bmpdecoder(void *bmp_addr, void *pdst, int dst_bpp)
 	width = get_unaligned_le32(&bmp->header.width);
 	height = get_unaligned_le32(&bmp->header.height);
 	bpp = get_unaligned_le16(&bmp->header.bit_count);
+	compression = get_unaligned_le32(&bmp->header.compression);
 	padded_width = width & 0x3 ? (width & ~0x3) + 4 : width;
 
 	if (height < 0)
@@ -169,6 +168,13 @@ int bmpdecoder(void *bmp_addr, void *pdst, int dst_bpp)
 	cmap_base = src + sizeof(bmp->header);
 	src = bmp_addr + get_unaligned_le32(&bmp->header.data_offset);
 
+	/* Convert row by row, walking the output backwards to flip */
+	dst_stride = width * (dst_bpp >> 3);
+	if (flip) {
+		dst += dst_stride * (height - 1);
+		dst_stride = -dst_stride;
+	}
+
 	switch (bpp) {
 	case 8:
 		if (dst_bpp != 16) {
@@ -176,7 +182,9 @@ int bmpdecoder(void *bmp_addr, void *pdst, int dst_bpp)
 			       dst_bpp);
 			return -1;
 		}
-		cmap = malloc(sizeof(cmap) * 256);
+		cmap = malloc(sizeof(*cmap) * 256);
+		if (!cmap)
+			return -1;
 
 		/* Set color map */
 		for (i = 0; i < 256; i++) {
@@ -189,47 +197,63 @@ int bmpdecoder(void *bmp_addr, void *pdst, int dst_bpp)
 		/*
 		 * only support convert 8bit bmap file to RGB565.
 		 */
-		if (get_unaligned_le32(&bmp->header.compression)) {
-			decode_rle8_bitmap(src, dst, cmap, width, height,
+		if (compression) {
+			decode_rle8_bitmap(src, pdst, cmap, width, height,
 					   bpp, 0, 0, flip);
 		} else {
-			int j;
-			stride = width * 2;
-
-			if (flip)
-				dst += stride * (height - 1);
-
-			for (i = 0; i < height; ++i) {
-				for (j = 0; j < width; j++) {
-					*(uint16_t *)dst = cmap[*(src++)];
-					dst += sizeof(uint16_t) / sizeof(*dst);
-				}
-				src += (padded_width - width);
-				if (flip)
-					dst -= stride * 2;
+			for (i = 0; i < height; i++) {
+				row_pal8((uint16_t *)dst, src, cmap, width);
+				src += padded_width;
+				dst += dst_stride;
 			}
 		}
 		free(cmap);
 		break;
-	case 24:
-		if (get_unaligned_le32(&bmp->header.compression)) {
-			printf("can't not support compression for 24bit bmap");
+	case 16:
+		if (dst_bpp != 16) {
+			printf("can't support covert bmap to bit[%d]\n",
+			       dst_bpp);
 			return -1;
 		}
-		stride = ALIGN(width * 3, 4);
-		if (flip)
-			src += stride * (height - 1);
-
+		/* BI_RGB is X1R5G5B5, BI_BITFIELDS gives the masks */
+		if (compression == BMP_BI_BITFIELDS &&
+		    get_unaligned_le32(cmap_base) == 0xf800) {
+			rgb565 = true;
+		} else if (compression != BMP_BI_RGB &&
+			   !(compression == BMP_BI_BITFIELDS &&
+			     get_unaligned_le32(cmap_base) == 0x7c00)) {
+			printf("unsupport 16 bit bmap masks\n");
+			return -1;
+		}
+		stride = ALIGN(width * 2, 4);
 		for (i = 0; i < height; i++) {
-			memcpy(dst, src, 3 * width);
-			dst += stride;
+			if (rgb565)
+				row_rgb565((uint16_t *)dst, src, width);
+			else
+				row_rgb555((uint16_t *)dst, src, width);
 			src += stride;
-			if (flip)
-				src -= stride * 2;
+			dst += dst_stride;
 		}
 		break;
-	case 16:
+	case 24:
 	case 32:
+		if (compression && compression != BMP_BI_BITFIELDS) {
+			printf("can't not support compression for %dbit bmap",
+			       bpp);
+			return -1;
+		}
+		if (dst_bpp != bpp) {
+			printf("can't support covert bmap to bit[%d]\n",
+			       dst_bpp);
+			return -1;
+		}
+		stride = ALIGN(width * (bpp >> 3), 4);
+		for (i = 0; i < height; i++) {
+			memcpy(dst, src, width * (bpp >> 3));
+			src += stride;
+			dst += dst_stride;
+		}
+		break;
 	default:
 		printf("unsupport bit=%d now\n", bpp);
 		return -1;
@@ -10,6 +10,7 @@
 #include <asm/arch-rockchip/clock.h>
 #include <asm/arch/vendor.h>
 #include <edid.h>
+#include <u-boot/crc.h>
 #include <dm/device.h>
 #include <dm/ofnode.h>
 #include <dm/read.h>
@@ -2391,6 +2392,122 @@ int rockchip_dw_hdmi_disable(struct display_state *state)
 	return 0;
 }
 
+#ifdef CONFIG_DRM_ROCKCHIP_DW_HDMI_EDID_CACHE
+#define HDMI_EDID_CACHE_MAGIC	0x45444943	/* "EDIC" */
+/* Bump whenever struct dw_hdmi_edid_cache or a structure in it changes */
+#define HDMI_EDID_CACHE_VERSION	1
+
+/**
+ * struct dw_hdmi_edid_cache - Output selected for a sink
+ *
+ * @magic:	HDMI_EDID_CACHE_MAGIC
+ * @version:	HDMI_EDID_CACHE_VERSION, a cache written by a U-Boot with a
+ *		different layout is ignored
+ * @key:	CRC32 of the EDID base block and of the base parameters the
+ *		output was selected with
+ * @mode:	Selected mode
+ * @display_info: Sink capabilities parsed from the full EDID
+ * @overscan:	Overscan from the base parameters
+ * @bus_format:	Selected bus format
+ * @sink_is_hdmi: true for an HDMI sink, false for DVI
+ * @sink_has_audio: true if the sink supports audio
+ * @crc:	CRC32 of all the fields above
+ */
+struct dw_hdmi_edid_cache {
+	u32 magic;
+	u32 version;
+	u32 key;
+	struct drm_display_mode mode;
+	struct drm_display_info display_info;
+	struct overscan overscan;
+	u32 bus_format;
+	u8 sink_is_hdmi;
+	u8 sink_has_audio;
+	u32 crc;
+};
+
+static u32 dw_hdmi_edid_cache_key(const u8 *edid)
+{
+	struct base_disp_info base_parameter;
+	u32 key;
+
+	key = crc32(0, edid, HDMI_EDID_BLOCK_SIZE);
+	memset(&base_parameter, 0, sizeof(base_parameter));
+	drm_rk_get_base_parameter(&base_parameter);
+
+	return crc32(key, (u8 *)&base_parameter, sizeof(base_parameter));
+}
+
+/*
+ * Only the EDID base block is read to identify the sink. If the same sink
+ * and base parameters were seen before, the output selected then is used
+ * and reading the extension blocks and parsing the modes is skipped.
+ * Returns -EFAULT if the base block could not be read, any other error
+ * leaves it in conn_state->edid for the full probe.
+ */
+static int dw_hdmi_edid_cache_load(struct dw_hdmi *hdmi,
+				   struct connector_state *conn_state,
+				   unsigned int *bus_format, u32 *keyp)
+{
+	struct dw_hdmi_edid_cache cache;
+	int ret;
+
+	*keyp = 0;
+	ret = drm_do_get_edid_base(&hdmi->adap, conn_state->edid);
+	if (ret)
+		return ret;
+	*keyp = dw_hdmi_edid_cache_key(conn_state->edid);
+
+	ret = vendor_storage_read(VENDOR_HDMI_EDID_CACHE_ID, &cache,
+				  sizeof(cache));
+	if (ret != sizeof(cache) || cache.magic != HDMI_EDID_CACHE_MAGIC ||
+	    cache.version != HDMI_EDID_CACHE_VERSION ||
+	    cache.crc != crc32(0, (u8 *)&cache, offsetof(typeof(cache), crc)))
+		return -ENOENT;
+	if (cache.key != *keyp) {
+		debug("%s: sink changed\n", __func__);
+		return -ESTALE;
+	}
+
+	hdmi->edid_data.mode_buf[0] = cache.mode;
+	hdmi->edid_data.modes = 1;
+	hdmi->edid_data.preferred_mode = &hdmi->edid_data.mode_buf[0];
+	hdmi->edid_data.display_info = cache.display_info;
+	hdmi->sink_is_hdmi = cache.sink_is_hdmi;
+	hdmi->sink_has_audio = cache.sink_has_audio;
+	conn_state->overscan = cache.overscan;
+	*bus_format = cache.bus_format;
+	printf("hdmi: using cached mode\n");
+
+	return 0;
+}
+
+static void dw_hdmi_edid_cache_save(struct dw_hdmi *hdmi,
+				    struct connector_state *conn_state,
+				    unsigned int bus_format, u32 key)
+{
+	struct dw_hdmi_edid_cache cache;
+
+	memset(&cache, 0, sizeof(cache));
+	cache.magic = HDMI_EDID_CACHE_MAGIC;
+	cache.version = HDMI_EDID_CACHE_VERSION;
+	cache.key = key;
+	cache.mode = *hdmi->edid_data.preferred_mode;
+	cache.display_info = hdmi->edid_data.display_info;
+	cache.display_info.bus_formats = NULL;
+	cache.display_info.num_bus_formats = 0;
+	cache.overscan = conn_state->overscan;
+	cache.bus_format = bus_format;
+	cache.sink_is_hdmi = hdmi->sink_is_hdmi;
+	cache.sink_has_audio = hdmi->sink_has_audio;
+	cache.crc = crc32(0, (u8 *)&cache, offsetof(typeof(cache), crc));
+
+	if (vendor_storage_write(VENDOR_HDMI_EDID_CACHE_ID, &cache,
+				 sizeof(cache)) != sizeof(cache))
+		debug("%s: failed to write cache\n", __func__);
+}
+#endif
+
 int rockchip_dw_hdmi_get_timing(struct display_state *state)
 {
 	int ret, i;
@@ -2401,11 +2518,23 @@ int rockchip_dw_hdmi_get_timing(struct display_state *state)
 	unsigned int bus_format;
 	struct overscan *overscan = &conn_state->overscan;
 	const u8 def_modes_vic[6] = {4, 16, 2, 17, 31, 19};
+#ifdef CONFIG_DRM_ROCKCHIP_DW_HDMI_EDID_CACHE
+	u32 key;
+#endif
 
 	if (!hdmi)
 		return -EFAULT;
 
+#ifdef CONFIG_DRM_ROCKCHIP_DW_HDMI_EDID_CACHE
+	ret = dw_hdmi_edid_cache_load(hdmi, conn_state, &bus_format, &key);
+	if (!ret)
+		goto selected;
+	/* Unless it could not be read, the base block is there already */
+	if (ret != -EFAULT)
+		ret = drm_do_get_edid_ext(&hdmi->adap, conn_state->edid);
+#else
 	ret = drm_do_get_edid(&hdmi->adap, conn_state->edid);
+#endif
 	if (!ret) {
 		hdmi->sink_is_hdmi =
 			drm_detect_hdmi_monitor(edid);
@@ -2436,6 +2565,12 @@ int rockchip_dw_hdmi_get_timing(struct display_state *state)
 	drm_rk_selete_output(&hdmi->edid_data, &bus_format,
 			     overscan, hdmi->dev_type);
 
+#ifdef CONFIG_DRM_ROCKCHIP_DW_HDMI_EDID_CACHE
+	/* Only remember what was selected from a real EDID */
+	if (key && edid->version)
+		dw_hdmi_edid_cache_save(hdmi, conn_state, bus_format, key);
+selected:
+#endif
 	*mode = *hdmi->edid_data.preferred_mode;
 	hdmi->vic = drm_match_cea_mode(mode);
 
@@ -1407,6 +1407,7 @@ enum {
 void drm_mode_sort(struct hdmi_edid_data *edid_data);
 int drm_mode_prune_invalid(struct hdmi_edid_data *edid_data);
 void drm_rk_filter_whitelist(struct hdmi_edid_data *edid_data);
+int drm_rk_get_base_parameter(struct base_disp_info *base_parameter);
 void drm_rk_selete_output(struct hdmi_edid_data *edid_data,
 			  unsigned int *bus_format,
 			  struct overscan *overscan,
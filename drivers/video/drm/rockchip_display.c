@@ -5,8 +5,10 @@
  */
 
 #include <asm/unaligned.h>
+#include <bootstage.h>
 #include <config.h>
 #include <common.h>
+#include <boot_rkimg.h>
 #include <errno.h>
 #include <linux/libfdt.h>
 #include <fdtdec.h>
@@ -16,6 +18,7 @@
 #include <linux/compat.h>
 #include <linux/media-bus-format.h>
 #include <malloc.h>
+#include <memalign.h>
 #include <video.h>
 #include <video_rockchip.h>
 #include <video_bridge.h>
@@ -893,6 +896,134 @@ struct rockchip_logo_cache *find_or_alloc_logo_cache(const char *bmp)
 	return logo_cache;
 }
 
+#if defined(CONFIG_DRM_ROCKCHIP_COMPRESSED_LOGO) && \
+	defined(CONFIG_ROCKCHIP_RESOURCE_IMAGE)
+#define LZ4F_MAGIC	0x184d2204
+
+static bool logo_is_compressed(const u8 *head)
+{
+	if (get_unaligned_le32(head) == LZ4F_MAGIC)
+		return true;
+#ifdef CONFIG_GZIP
+	if (head[0] == 0x1f && head[1] == 0x8b)
+		return true;
+#endif
+	return false;
+}
+#else
+static bool logo_is_compressed(const u8 *head)
+{
+	return false;
+}
+#endif
+
+#ifdef CONFIG_DRM_ROCKCHIP_LOGO_PARTITION
+#define LOGO_PART_PREFIX	"part:"
+
+static int find_logo_part(const char *part_name, struct blk_desc **dev_descp,
+			  disk_partition_t *part_info)
+{
+	*dev_descp = rockchip_get_bootdev();
+	if (!*dev_descp)
+		return -ENODEV;
+
+	if (part_get_info_by_name(*dev_descp, part_name, part_info) < 0) {
+		debug("%s: no %s partition\n", __func__, part_name);
+		return -ENOENT;
+	}
+
+	return 0;
+}
+
+/*
+ * Read the first @len bytes of a logo partition. Whole blocks go straight
+ * to @buf, the last partial one through a bounce buffer so that nothing
+ * past @len is written.
+ */
+static int read_logo_part(void *buf, const char *part_name, int len)
+{
+	struct blk_desc *dev_desc;
+	disk_partition_t part_info;
+	lbaint_t blkcnt;
+	char *bounce;
+	int rem, ret;
+
+	ret = find_logo_part(part_name, &dev_desc, &part_info);
+	if (ret)
+		return ret;
+
+	if (len < 4 || (u64)len > (u64)part_info.size * dev_desc->blksz)
+		return -EINVAL;
+
+	blkcnt = len / dev_desc->blksz;
+	if (blkcnt &&
+	    blk_dread(dev_desc, part_info.start, blkcnt, buf) != blkcnt)
+		return -EIO;
+
+	rem = len % dev_desc->blksz;
+	if (rem) {
+		bounce = malloc_cache_aligned(dev_desc->blksz);
+		if (!bounce)
+			return -ENOMEM;
+		if (blk_dread(dev_desc, part_info.start + blkcnt, 1,
+			      bounce) != 1) {
+			free(bounce);
+			return -EIO;
+		}
+		memcpy(buf + blkcnt * dev_desc->blksz, bounce, rem);
+		free(bounce);
+	}
+
+	/* An erased or stale partition must not be taken for a logo */
+	if (memcmp(buf, "BM", 2) && !logo_is_compressed(buf))
+		return -EINVAL;
+
+	return len;
+}
+
+/*
+ * A partition does not record the length of a compressed logo, all of it
+ * is read, up to the size of the display memory pool
+ */
+static int __maybe_unused get_logo_part_size(const char *part_name)
+{
+	struct blk_desc *dev_desc;
+	disk_partition_t part_info;
+	int ret;
+
+	ret = find_logo_part(part_name, &dev_desc, &part_info);
+	if (ret)
+		return ret;
+
+	return min_t(u64, (u64)part_info.size * dev_desc->blksz,
+		     MEMORY_POOL_SIZE);
+}
+#endif
+
+/*
+ * Read the first @len bytes of a logo, from resource.img or, for a
+ * "part:<name>" logo, from the start of partition <name>.
+ */
+static int read_logo_file(void *buf, const char *bmp_name, int len)
+{
+#ifdef CONFIG_DRM_ROCKCHIP_LOGO_PARTITION
+	if (!strncmp(bmp_name, LOGO_PART_PREFIX, strlen(LOGO_PART_PREFIX)))
+		return read_logo_part(buf, bmp_name + strlen(LOGO_PART_PREFIX),
+				      len);
+#endif
+	return rockchip_read_resource_file(buf, bmp_name, 0, len);
+}
+
+static int __maybe_unused get_logo_file_size(const char *bmp_name)
+{
+#ifdef CONFIG_DRM_ROCKCHIP_LOGO_PARTITION
+	if (!strncmp(bmp_name, LOGO_PART_PREFIX, strlen(LOGO_PART_PREFIX)))
+		return get_logo_part_size(bmp_name +
+					  strlen(LOGO_PART_PREFIX));
+#endif
+	return rockchip_get_resource_file_size(NULL, bmp_name);
+}
+
 /* Note: used only for rkfb kernel driver */
 static int load_kernel_bmp_logo(struct logo_info *logo, const char *bmp_name)
 {
@@ -928,12 +1059,77 @@ static int load_kernel_bmp_logo(struct logo_info *logo, const char *bmp_name)
 #endif
 }
 
+#if defined(CONFIG_DRM_ROCKCHIP_COMPRESSED_LOGO) && \
+	defined(CONFIG_ROCKCHIP_RESOURCE_IMAGE)
+/*
+ * Read a compressed logo and decompress it into the free part of the
+ * display memory pool, which is then reserved for the BMP.
+ */
+static void *load_compressed_bmp(const char *bmp_name, const u8 *head)
+{
+	unsigned long roundup_memory = roundup(memory_end, PAGE_SIZE);
+	size_t dst_len = memory_start + MEMORY_POOL_SIZE - roundup_memory;
+	void *src, *dst = (void *)roundup_memory;
+	int size, len, ret;
+
+	size = get_logo_file_size(bmp_name);
+	if (size <= 0)
+		return NULL;
+
+	src = malloc(ALIGN(size, RK_BLK_SIZE));
+	if (!src)
+		return NULL;
+
+	len = read_logo_file(src, bmp_name, size);
+	if (len != size) {
+		printf("failed to load bmp %s\n", bmp_name);
+		dst = NULL;
+		goto out;
+	}
+
+	if (get_unaligned_le32(head) == LZ4F_MAGIC) {
+		ret = ulz4fn(src, size, dst, &dst_len);
+	} else {
+#ifdef CONFIG_GZIP
+		unsigned long gz_len = size;
+
+		ret = gunzip(dst, dst_len, src, &gz_len);
+		dst_len = gz_len;
+#else
+		ret = -EINVAL;
+#endif
+	}
+	if (ret || dst_len < sizeof(struct bmp_header)) {
+		printf("failed to decompress bmp %s: %d\n", bmp_name, ret);
+		dst = NULL;
+		goto out;
+	}
+
+	dst = get_display_buffer(dst_len);
+	/* Shown in place for 24/32bpp, the VOP reads it from DRAM */
+	if (dst)
+		flush_dcache_range((ulong)dst,
+				   ALIGN((ulong)dst + dst_len,
+					 CONFIG_SYS_CACHELINE_SIZE));
+	debug("%s: %s %d -> %zu bytes\n", __func__, bmp_name, size, dst_len);
+out:
+	free(src);
+
+	return dst;
+}
+#else
+static void *load_compressed_bmp(const char *bmp_name, const u8 *head)
+{
+	return NULL;
+}
+#endif
+
 static int load_bmp_logo(struct logo_info *logo, const char *bmp_name)
 {
 #ifdef CONFIG_ROCKCHIP_RESOURCE_IMAGE
 	struct rockchip_logo_cache *logo_cache;
-	struct bmp_header *header;
-	void *dst = NULL, *pdst;
+	struct bmp_header *header, *bmp;
+	void *dst = NULL, *pdst = NULL;
 	int size, len;
 	int ret = 0;
 	int reserved = 0;
@@ -945,7 +1141,11 @@ static int load_bmp_logo(struct logo_info *logo, const char *bmp_name)
 		return -ENOMEM;
 
 	if (logo_cache->logo.mem) {
+		/* The display mode belongs to the caller, not to the bmp */
+		int mode = logo->mode;
+
 		memcpy(logo, &logo_cache->logo, sizeof(*logo));
+		logo->mode = mode;
 		return 0;
 	}
 
@@ -953,20 +1153,34 @@ static int load_bmp_logo(struct logo_info *logo, const char *bmp_name)
 	if (!header)
 		return -ENOMEM;
 
-	len = rockchip_read_resource_file(header, bmp_name, 0, RK_BLK_SIZE);
+	len = read_logo_file(header, bmp_name, RK_BLK_SIZE);
 	if (len != RK_BLK_SIZE) {
 		ret = -EINVAL;
 		goto free_header;
 	}
 
-	logo->bpp = get_unaligned_le16(&header->bit_count);
-	logo->width = get_unaligned_le32(&header->width);
-	logo->height = get_unaligned_le32(&header->height);
-	reserved = get_unaligned_le32(&header->reserved);
+	bmp = header;
+	if (logo_is_compressed((u8 *)header)) {
+		pdst = load_compressed_bmp(bmp_name, (u8 *)header);
+		if (!pdst) {
+			ret = -EINVAL;
+			goto free_header;
+		}
+		bmp = pdst;
+	}
+
+	logo->bpp = get_unaligned_le16(&bmp->bit_count);
+	logo->width = get_unaligned_le32(&bmp->width);
+	logo->height = get_unaligned_le32(&bmp->height);
+	reserved = get_unaligned_le32(&bmp->reserved);
 	if (logo->height < 0)
 	    logo->height = -logo->height;
-	size = get_unaligned_le32(&header->file_size);
-	if (!can_direct_logo(logo->bpp)) {
+	size = get_unaligned_le32(&bmp->file_size);
+	if (pdst) {
+		/* Already decompressed into the display buffer */
+		if (can_direct_logo(logo->bpp))
+			dst = pdst;
+	} else if (!can_direct_logo(logo->bpp)) {
 		if (size > MEMORY_POOL_SIZE) {
 			printf("failed to use boot buf as temp bmp buffer\n");
 			ret = -ENOMEM;
@@ -978,14 +1192,20 @@ static int load_bmp_logo(struct logo_info *logo, const char *bmp_name)
 		pdst = get_display_buffer(size);
 		dst = pdst;
 	}
-
-	len = rockchip_read_resource_file(pdst, bmp_name, 0, size);
-	if (len != size) {
-		printf("failed to load bmp %s\n", bmp_name);
-		ret = -ENOENT;
+	if (!pdst) {
+		ret = -ENOMEM;
 		goto free_header;
 	}
 
+	if (bmp == header) {
+		len = read_logo_file(pdst, bmp_name, size);
+		if (len != size) {
+			printf("failed to load bmp %s\n", bmp_name);
+			ret = -ENOENT;
+			goto free_header;
+		}
+	}
+
 	if (!can_direct_logo(logo->bpp)) {
 		int dst_size;
 		/*
@@ -1011,7 +1231,7 @@ static int load_bmp_logo(struct logo_info *logo, const char *bmp_name)
 		logo->offset = 0;
 		logo->ymirror = 0;
 	} else {
-		logo->offset = get_unaligned_le32(&header->data_offset);
+		logo->offset = get_unaligned_le32(&bmp->data_offset);
 		if (reserved == BMP_PROCESSED_FLAG)
 			logo->ymirror = 0;
 		else
@@ -1047,9 +1267,46 @@ void rockchip_show_fbbase(ulong fbbase)
 	}
 }
 
+/*
+ * A logo laid out like the one on screen only needs the plane address
+ * switched, the VOP scans the resident copy out of the logo cache.
+ */
+static int display_flip_logo(struct display_state *state,
+			     struct logo_info *logo)
+{
+	struct crtc_state *crtc_state = &state->crtc_state;
+	struct logo_info *cur = &state->logo;
+
+	if (!state->is_enable || !cur->mem || cur->mode != logo->mode ||
+	    cur->width != logo->width || cur->height != logo->height ||
+	    cur->bpp != logo->bpp)
+		return -EINVAL;
+
+	crtc_state->dma_addr = (u32)(unsigned long)logo->mem + logo->offset;
+	crtc_state->ymirror = logo->ymirror;
+	memcpy(cur, logo, sizeof(*logo));
+
+	return display_set_plane(state);
+}
+
+/*
+ * Decode @bmp into the logo cache without showing it, so that a later
+ * rockchip_show_bmp() of the same name is a plane flip only.
+ */
+int rockchip_preload_bmp(const char *bmp)
+{
+	struct logo_info logo = { 0 };
+
+	if (list_empty(&rockchip_display_list))
+		return -ENODEV;
+
+	return load_bmp_logo(&logo, bmp);
+}
+
 int rockchip_show_bmp(const char *bmp)
 {
 	struct display_state *s;
+	struct logo_info logo;
 	int ret = 0;
 
 	if (!bmp) {
@@ -1059,15 +1316,30 @@ int rockchip_show_bmp(const char *bmp)
 	}
 
 	list_for_each_entry(s, &rockchip_display_list, head) {
-		s->logo.mode = s->charge_logo_mode;
-		if (load_bmp_logo(&s->logo, bmp))
+		logo.mode = s->charge_logo_mode;
+		if (load_bmp_logo(&logo, bmp))
+			continue;
+		if (!display_flip_logo(s, &logo))
 			continue;
+		memcpy(&s->logo, &logo, sizeof(logo));
 		ret = display_logo(s);
 	}
 
 	return ret;
 }
 
+static int load_uboot_logo(struct logo_info *logo, const char *bmp_name)
+{
+#ifdef CONFIG_DRM_ROCKCHIP_LOGO_PARTITION
+	/* The raw logo partition, if any, is the quickest to get on screen */
+	if (CONFIG_DRM_ROCKCHIP_LOGO_PARTITION[0] &&
+	    !load_bmp_logo(logo, LOGO_PART_PREFIX
+			   CONFIG_DRM_ROCKCHIP_LOGO_PARTITION))
+		return 0;
+#endif
+	return load_bmp_logo(logo, bmp_name);
+}
+
 int rockchip_show_logo(void)
 {
 	struct display_state *s;
@@ -1075,10 +1347,15 @@ int rockchip_show_logo(void)
 
 	list_for_each_entry(s, &rockchip_display_list, head) {
 		s->logo.mode = s->logo_mode;
-		if (load_bmp_logo(&s->logo, s->ulogo_name))
+		if (load_uboot_logo(&s->logo, s->ulogo_name)) {
 			printf("failed to display uboot logo\n");
-		else
+		} else {
 			ret = display_logo(s);
+			/* First pixel on screen, only the first mark counts */
+			if (!ret)
+				bootstage_mark_name(BOOTSTAGE_ID_DISPLAY_LOGO,
+						    "display_logo");
+		}
 
 		/* Load kernel bmp in rockchip_display_fixup() later */
 	}
@@ -1408,6 +1685,9 @@ static int rockchip_display_probe(struct udevice *dev)
 	uc_priv->bpix = VIDEO_BPP32;
 
 	#ifdef CONFIG_DRM_ROCKCHIP_VIDEO_FRAMEBUFFER
+	#ifdef CONFIG_DRM_ROCKCHIP_CONSOLE_PAN
+	uc_priv->pan_size = DRM_ROCKCHIP_FB_SIZE;
+	#endif
 	rockchip_show_fbbase(plat->base);
 	video_set_flush_dcache(dev, true);
 	#endif
@@ -1415,6 +1695,60 @@ static int rockchip_display_probe(struct udevice *dev)
 	return 0;
 }
 
+/*
+ * Describe the running pipeline, so that the kernel can take it over
+ * without blanking it. See
+ * doc/device-tree-bindings/video/rockchip-display-handoff.txt
+ */
+static void display_fixup_handoff(struct display_state *s, void *blob,
+				  const char *path)
+{
+	struct crtc_state *crtc_state = &s->crtc_state;
+	struct drm_display_mode *mode = &s->conn_state.mode;
+	struct rockchip_phy *phy = s->conn_state.phy;
+	fdt32_t rect[4];
+
+#define FDT_SET_U32(name, val) \
+		do_fixup_by_path_u32(blob, path, name, val, 1);
+
+	FDT_SET_U32("handoff,version", ROCKCHIP_DISPLAY_HANDOFF_VERSION);
+	FDT_SET_U32("handoff,enabled", s->is_enable);
+	if (!s->is_enable)
+		return;
+
+	FDT_SET_U32("handoff,clock", mode->clock);
+	FDT_SET_U32("handoff,crtc_hsync_start", mode->crtc_hsync_start);
+	FDT_SET_U32("handoff,crtc_htotal", mode->crtc_htotal);
+	FDT_SET_U32("handoff,crtc_vsync_start", mode->crtc_vsync_start);
+	FDT_SET_U32("handoff,crtc_vtotal", mode->crtc_vtotal);
+	FDT_SET_U32("handoff,bus_format", s->conn_state.bus_format);
+	FDT_SET_U32("handoff,output_mode", s->conn_state.output_mode);
+
+	FDT_SET_U32("handoff,plane_addr", crtc_state->dma_addr);
+	FDT_SET_U32("handoff,plane_format", crtc_state->format);
+	FDT_SET_U32("handoff,plane_rb_swap", crtc_state->rb_swap);
+	FDT_SET_U32("handoff,plane_ymirror", crtc_state->ymirror);
+	FDT_SET_U32("handoff,plane_stride", crtc_state->xvir * 4);
+	rect[0] = cpu_to_fdt32(crtc_state->src_x);
+	rect[1] = cpu_to_fdt32(crtc_state->src_y);
+	rect[2] = cpu_to_fdt32(crtc_state->src_w);
+	rect[3] = cpu_to_fdt32(crtc_state->src_h);
+	do_fixup_by_path(blob, path, "handoff,plane_src", rect, sizeof(rect), 1);
+	rect[0] = cpu_to_fdt32(crtc_state->crtc_x);
+	rect[1] = cpu_to_fdt32(crtc_state->crtc_y);
+	rect[2] = cpu_to_fdt32(crtc_state->crtc_w);
+	rect[3] = cpu_to_fdt32(crtc_state->crtc_h);
+	do_fixup_by_path(blob, path, "handoff,plane_dst", rect, sizeof(rect), 1);
+
+	if (phy) {
+		FDT_SET_U32("handoff,phy_enabled", phy->power_on);
+		FDT_SET_U32("handoff,phy_pll_rate", phy->pll_rate);
+	}
+	FDT_SET_U32("handoff,panel_enabled",
+		    state_get_panel(s) && state_get_panel(s)->enabled);
+#undef FDT_SET_U32
+}
+
 void rockchip_display_fixup(void *blob)
 {
 	const struct rockchip_connector_funcs *conn_funcs;
@@ -1479,7 +1813,7 @@ void rockchip_display_fixup(void *blob)
 
 		np = ofnode_to_np(s->node);
 		path = np->full_name;
-		fdt_increase_size(blob, 0x400);
+		fdt_increase_size(blob, 0x800);
 #define FDT_SET_U32(name, val) \
 		do_fixup_by_path_u32(blob, path, name, val, 1);
 
@@ -1502,9 +1836,37 @@ void rockchip_display_fixup(void *blob)
 		FDT_SET_U32("overscan,top_margin", s->conn_state.overscan.top_margin);
 		FDT_SET_U32("overscan,bottom_margin", s->conn_state.overscan.bottom_margin);
 #undef FDT_SET_U32
+
+		display_fixup_handoff(s, blob, path);
+	}
+}
+
+/* Scan the console out from @fb, displays showing a bmp are left alone */
+static int rockchip_display_set_fb_base(struct udevice *dev, void *fb)
+{
+	struct video_priv *uc_priv = dev_get_uclass_priv(dev);
+	struct display_state *s;
+	struct logo_info logo;
+
+	list_for_each_entry(s, &rockchip_display_list, head) {
+		if (s->logo.mem < (char *)uc_priv->pan_base ||
+		    s->logo.mem >= (char *)uc_priv->pan_base + uc_priv->pan_size)
+			continue;
+		memcpy(&logo, &s->logo, sizeof(logo));
+		logo.mem = fb;
+		if (!display_flip_logo(s, &logo))
+			continue;
+		memcpy(&s->logo, &logo, sizeof(logo));
+		display_logo(s);
 	}
+
+	return 0;
 }
 
+static const struct video_ops rockchip_display_ops = {
+	.set_fb_base	= rockchip_display_set_fb_base,
+};
+
 int rockchip_display_bind(struct udevice *dev)
 {
 	struct video_uc_platdata *plat = dev_get_uclass_platdata(dev);
@@ -1523,6 +1885,7 @@ U_BOOT_DRIVER(rockchip_display) = {
 	.name	= "rockchip_display",
 	.id	= UCLASS_VIDEO,
 	.of_match = rockchip_display_ids,
+	.ops	= &rockchip_display_ops,
 	.bind	= rockchip_display_bind,
 	.probe	= rockchip_display_probe,
 };
@@ -12,6 +12,9 @@
 #include <edid.h>
 #include <dm/ofnode.h>
 
+/* Layout of the handoff,* properties passed to the kernel */
+#define ROCKCHIP_DISPLAY_HANDOFF_VERSION	1
+
 #define ROCKCHIP_OUTPUT_DSI_DUAL_CHANNEL	BIT(0)
 #define ROCKCHIP_OUTPUT_DSI_DUAL_LINK		BIT(1)
 
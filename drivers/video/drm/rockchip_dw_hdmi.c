@@ -635,20 +635,47 @@ static unsigned int drm_rk_select_color(struct hdmi_edid_data *edid_data,
 	}
 }
 
+int drm_rk_get_base_parameter(struct base_disp_info *base_parameter)
+{
+	struct blk_desc *dev_desc;
+	disk_partition_t part_info;
+	char baseparameter_buf[8 * RK_BLK_SIZE] __aligned(ARCH_DMA_MINALIGN);
+	int ret;
+
+	dev_desc = rockchip_get_bootdev();
+	if (!dev_desc) {
+		printf("%s: Could not find device\n", __func__);
+		return -ENODEV;
+	}
+
+	if (part_get_info_by_name(dev_desc, "baseparameter", &part_info) < 0) {
+		printf("Could not find baseparameter partition\n");
+		return -ENOENT;
+	}
+
+	ret = blk_dread(dev_desc, part_info.start, 1,
+			(void *)baseparameter_buf);
+	if (ret < 0) {
+		printf("read baseparameter failed\n");
+		return -EIO;
+	}
+
+	memcpy(base_parameter, baseparameter_buf, sizeof(*base_parameter));
+
+	return 0;
+}
+
 void drm_rk_selete_output(struct hdmi_edid_data *edid_data,
 			  unsigned int *bus_format,
 			  struct overscan *overscan,
 			  enum dw_hdmi_devtype dev_type)
 {
-	int ret, i, screen_size;
+	int i, screen_size;
 	struct base_disp_info base_parameter;
 	const struct base_overscan *scan;
 	struct base_screen_info *screen_info = NULL;
 	int max_scan = 100;
 	int min_scan = 51;
-	struct blk_desc *dev_desc;
-	disk_partition_t part_info;
-	char baseparameter_buf[8 * RK_BLK_SIZE] __aligned(ARCH_DMA_MINALIGN);
 
 	overscan->left_margin = max_scan;
 	overscan->right_margin = max_scan;
@@ -660,25 +687,9 @@ void drm_rk_selete_output(struct hdmi_edid_data *edid_data,
 	else
 		*bus_format = MEDIA_BUS_FMT_YUV8_1X24;
 
-	dev_desc = rockchip_get_bootdev();
-	if (!dev_desc) {
-		printf("%s: Could not find device\n", __func__);
+	if (drm_rk_get_base_parameter(&base_parameter))
 		return;
-	}
-
-	if (part_get_info_by_name(dev_desc, "baseparameter", &part_info) < 0) {
-		printf("Could not find baseparameter partition\n");
-		return;
-	}
-
-	ret = blk_dread(dev_desc, part_info.start, 1,
-			(void *)baseparameter_buf);
-	if (ret < 0) {
-		printf("read baseparameter failed\n");
-		return;
-	}
 
-	memcpy(&base_parameter, baseparameter_buf, sizeof(base_parameter));
 	scan = &base_parameter.scan;
 
 	if (scan->leftscale < min_scan && scan->leftscale > 0)
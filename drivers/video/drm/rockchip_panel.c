@@ -61,6 +61,7 @@ struct rockchip_panel_plat {
 
 struct rockchip_panel_priv {
 	bool prepared;
+	bool prepare_failed;
 	bool enabled;
 	struct udevice *power_supply;
 	struct udevice *backlight;
@@ -264,8 +265,15 @@ static void panel_simple_prepare(struct rockchip_panel *panel)
 	if (priv->prepared)
 		return;
 
-	if (priv->power_supply)
-		regulator_set_enable(priv->power_supply, !plat->power_invert);
+	priv->prepare_failed = false;
+	if (priv->power_supply) {
+		ret = regulator_set_enable(priv->power_supply,
+					   !plat->power_invert);
+		if (ret && ret != -ENOSYS) {
+			printf("failed to enable power supply: %d\n", ret);
+			priv->prepare_failed = true;
+		}
+	}
 
 	if (dm_gpio_is_valid(&priv->enable_gpio))
 		dm_gpio_set_value(&priv->enable_gpio, 1);
@@ -294,8 +302,10 @@ static void panel_simple_prepare(struct rockchip_panel *panel)
 							   plat->on_cmds);
 		else
 			ret = rockchip_panel_send_dsi_cmds(dsi, plat->on_cmds);
-		if (ret)
+		if (ret) {
 			printf("failed to send on cmds: %d\n", ret);
+			priv->prepare_failed = true;
+		}
 	}
 
 	priv->prepared = true;
@@ -354,6 +364,7 @@ static void panel_simple_enable(struct rockchip_panel *panel)
 		backlight_enable(priv->backlight);
 
 	priv->enabled = true;
+	panel->enabled = priv->prepared && !priv->prepare_failed;
 }
 
 static void panel_simple_disable(struct rockchip_panel *panel)
@@ -371,6 +382,7 @@ static void panel_simple_disable(struct rockchip_panel *panel)
 		mdelay(plat->delay.disable);
 
 	priv->enabled = false;
+	panel->enabled = false;
 }
 
 static void panel_simple_init(struct rockchip_panel *panel)
@@ -24,6 +24,7 @@ struct rockchip_panel {
 	unsigned int bpc;
 	const struct rockchip_panel_funcs *funcs;
 	const void *data;
+	bool enabled;	/* powered up and turned on without error */
 
 	struct display_state *state;
 };
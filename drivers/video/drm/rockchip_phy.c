@@ -5,6 +5,7 @@
  */
 
 #include <common.h>
+#include <linux/err.h>
 #include "rockchip_phy.h"
 
 int rockchip_phy_init(struct rockchip_phy *phy)
@@ -20,22 +21,34 @@ int rockchip_phy_init(struct rockchip_phy *phy)
 
 int rockchip_phy_power_on(struct rockchip_phy *phy)
 {
+	int ret;
+
 	if (!phy)
 		return -ENODEV;
 
-	if (phy->funcs && phy->funcs->power_on)
-		return phy->funcs->power_on(phy);
+	if (phy->funcs && phy->funcs->power_on) {
+		ret = phy->funcs->power_on(phy);
+		if (ret)
+			return ret;
+	}
+	phy->power_on = true;
 
 	return 0;
 }
 
 int rockchip_phy_power_off(struct rockchip_phy *phy)
 {
+	int ret;
+
 	if (!phy)
 		return -ENODEV;
 
-	if (phy->funcs && phy->funcs->power_off)
-		return phy->funcs->power_off(phy);
+	if (phy->funcs && phy->funcs->power_off) {
+		ret = phy->funcs->power_off(phy);
+		if (ret)
+			return ret;
+	}
+	phy->power_on = false;
 
 	return 0;
 }
@@ -46,8 +59,12 @@ unsigned long rockchip_phy_set_pll(struct rockchip_phy *phy,
 	if (!phy)
 		return -ENODEV;
 
-	if (phy->funcs && phy->funcs->set_pll)
-		return phy->funcs->set_pll(phy, rate);
+	if (phy->funcs && phy->funcs->set_pll) {
+		rate = phy->funcs->set_pll(phy, rate);
+		if (!IS_ERR_VALUE(rate))
+			phy->pll_rate = rate;
+		return rate;
+	}
 
 	return 0;
 }
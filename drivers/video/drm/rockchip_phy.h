@@ -31,6 +31,10 @@ struct rockchip_phy {
 	const struct rockchip_phy_funcs *funcs;
 	const void *data;
 	int soc_type;
+
+	/* State handed over to the kernel */
+	bool power_on;
+	unsigned long pll_rate;
 };
 
 int rockchip_phy_init(struct rockchip_phy *phy);
@@ -19,31 +19,58 @@
 #define CONFIG_CONSOLE_SCROLL_LINES 1
 #endif
 
+/*
+ * Record the lines touched so that video_sync() only flushes those. Rotated
+ * consoles do not draw along display lines, they mark the whole display.
+ */
+static void vidconsole_damage(struct udevice *dev, int y, int height)
+{
+	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
+
+	if (vid_priv->rot)
+		video_damage(dev->parent, 0, vid_priv->ysize);
+	else
+		video_damage(dev->parent, y, height);
+}
+
 int vidconsole_putc_xy(struct udevice *dev, uint x, uint y, char ch)
 {
+	struct vidconsole_priv *priv = dev_get_uclass_priv(dev);
 	struct vidconsole_ops *ops = vidconsole_get_ops(dev);
+	int ret;
 
 	if (!ops->putc_xy)
 		return -ENOSYS;
-	return ops->putc_xy(dev, x, y, ch);
+	ret = ops->putc_xy(dev, x, y, ch);
+	if (ret >= 0)
+		vidconsole_damage(dev, y, priv->y_charsize);
+
+	return ret;
 }
 
 int vidconsole_move_rows(struct udevice *dev, uint rowdst, uint rowsrc,
 			 uint count)
 {
+	struct vidconsole_priv *priv = dev_get_uclass_priv(dev);
 	struct vidconsole_ops *ops = vidconsole_get_ops(dev);
 
 	if (!ops->move_rows)
 		return -ENOSYS;
+	vidconsole_damage(dev, rowdst * priv->y_charsize,
+			  count * priv->y_charsize);
+
 	return ops->move_rows(dev, rowdst, rowsrc, count);
 }
 
 int vidconsole_set_row(struct udevice *dev, uint row, int clr)
 {
+	struct vidconsole_priv *priv = dev_get_uclass_priv(dev);
 	struct vidconsole_ops *ops = vidconsole_get_ops(dev);
 
 	if (!ops->set_row)
 		return -ENOSYS;
+	vidconsole_damage(dev, row * priv->y_charsize, priv->y_charsize);
+
 	return ops->set_row(dev, row, clr);
 }
 
@@ -64,6 +91,9 @@ static int vidconsole_back(struct udevice *dev)
 	int ret;
 
 	if (ops->backspace) {
+		/* This may erase the end of the previous line */
+		vidconsole_damage(dev, priv->ycur - priv->y_charsize,
+				  2 * priv->y_charsize);
 		ret = ops->backspace(dev);
 		if (ret != -ENOSYS)
 			return ret;
@@ -77,7 +107,6 @@ static int vidconsole_back(struct udevice *dev)
 		if (priv->ycur < 0)
 			priv->ycur = 0;
 	}
-	video_sync(dev->parent);
 
 	return 0;
 }
@@ -94,17 +123,21 @@ static void vidconsole_newline(struct udevice *dev)
 	priv->xcur_frac = priv->xstart_frac;
 	priv->ycur += priv->y_charsize;
 
-	/* Check if we need to scroll the terminal */
+	/*
+	 * Check if we need to scroll the terminal. Moving the start address
+	 * of the display is much cheaper than moving the text, when the
+	 * video device supports it.
+	 */
 	if ((priv->ycur + priv->y_charsize) / priv->y_charsize > priv->rows) {
-		vidconsole_move_rows(dev, 0, rows, priv->rows - rows);
-		for (i = 0; i < rows; i++)
-			vidconsole_set_row(dev, priv->rows - i - 1,
-					   vid_priv->colour_bg);
+		if (video_scroll(vid_dev, rows * priv->y_charsize) == -ENOSYS) {
+			vidconsole_move_rows(dev, 0, rows, priv->rows - rows);
+			for (i = 0; i < rows; i++)
+				vidconsole_set_row(dev, priv->rows - i - 1,
+						   vid_priv->colour_bg);
+		}
 		priv->ycur -= rows * priv->y_charsize;
 	}
 	priv->last_ch = 0;
-
-	video_sync(dev->parent);
 }
 
 int vidconsole_put_char(struct udevice *dev, char ch)
@@ -166,6 +199,7 @@ static void vidconsole_putc(struct stdio_dev *sdev, const char ch)
 	video_sync(dev->parent);
 }
 
+/* Draw the whole string first, the display is only synced once */
 static void vidconsole_puts(struct stdio_dev *sdev, const char *s)
 {
 	struct udevice *dev = sdev->priv;
@@ -262,8 +296,6 @@ static int do_video_puts(cmd_tbl_t *cmdtp, int flag, int argc,
 		vidconsole_put_char(dev, *s);
 	video_sync(dev->parent);
 
-	video_sync(dev->parent);
-
 	return 0;
 }
 
@@ -99,25 +99,57 @@ int video_reserve(ulong *addrp)
 	return 0;
 }
 
-static int video_clear(struct udevice *dev)
+/* Fill @height lines from @y with the background colour */
+static void video_fill(struct video_priv *priv, int y, int height)
 {
-	struct video_priv *priv = dev_get_uclass_priv(dev);
+	void *start = priv->fb + y * priv->line_length;
+	int size = height * priv->line_length;
 
 	if (priv->bpix == VIDEO_BPP32) {
-		u32 *ppix = priv->fb;
-		u32 *end = priv->fb + priv->fb_size;
+		u32 *ppix = start;
+		u32 *end = start + size;
 
 		while (ppix < end)
 			*ppix++ = priv->colour_bg;
 	} else {
-		memset(priv->fb, priv->colour_bg, priv->fb_size);
+		memset(start, priv->colour_bg, size);
 	}
+}
+
+static int video_clear(struct udevice *dev)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+
+	video_fill(priv, 0, priv->ysize);
+	video_damage(dev, 0, priv->ysize);
 
 	return 0;
 }
 
-/* Flush video activity to the caches */
-void video_sync(struct udevice *vid)
+void video_damage(struct udevice *vid, int y, int height)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+
+	if (y < 0) {
+		height += y;
+		y = 0;
+	}
+	if (y + height > priv->ysize)
+		height = priv->ysize - y;
+	if (height <= 0)
+		return;
+
+	if (priv->damage_yend <= priv->damage_ystart) {
+		priv->damage_ystart = y;
+		priv->damage_yend = y + height;
+	} else {
+		priv->damage_ystart = min(priv->damage_ystart, y);
+		priv->damage_yend = max(priv->damage_yend, y + height);
+	}
+}
+
+/* Flush the lines recorded by video_damage() and start a new range */
+static void video_flush_damage(struct video_priv *priv)
 {
 	/*
 	 * flush_dcache_range() is declared in common.h but it seems that some
@@ -125,15 +157,15 @@ void video_sync(struct udevice *vid)
 	 * out whether it exists? For now, ARM is safe.
 	 */
 #if defined(CONFIG_ARM) && !defined(CONFIG_SYS_DCACHE_OFF)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
+	if (priv->flush_dcache && priv->damage_yend > priv->damage_ystart) {
+		ulong start, end;
 
-	if (priv->flush_dcache) {
-		flush_dcache_range((ulong)priv->fb,
-				   ALIGN((ulong)priv->fb + priv->fb_size,
-					 CONFIG_SYS_CACHELINE_SIZE));
+		start = (ulong)priv->fb + priv->damage_ystart * priv->line_length;
+		end = (ulong)priv->fb + priv->damage_yend * priv->line_length;
+		flush_dcache_range(start & ~(CONFIG_SYS_CACHELINE_SIZE - 1),
+				   ALIGN(end, CONFIG_SYS_CACHELINE_SIZE));
 	}
 #elif defined(CONFIG_VIDEO_SANDBOX_SDL)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
 	static ulong last_sync;
 
 	if (get_timer(last_sync) > 10) {
@@ -141,6 +173,59 @@ void video_sync(struct udevice *vid)
 		last_sync = get_timer(0);
 	}
 #endif
+	priv->damage_ystart = priv->ysize;
+	priv->damage_yend = 0;
+}
+
+/* Flush video activity to the caches */
+void video_sync(struct udevice *vid)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+
+	/*
+	 * Nothing recorded means the caller wrote to the frame buffer
+	 * directly, so flush all of it
+	 */
+	if (priv->damage_yend <= priv->damage_ystart)
+		video_damage(vid, 0, priv->ysize);
+	video_flush_damage(priv);
+}
+
+void video_fix_fb(struct udevice *vid)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+
+	priv->fb_fixed = true;
+}
+
+int video_scroll(struct udevice *vid, int lines)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	struct video_ops *ops = video_get_ops(vid);
+	int step = lines * priv->line_length;
+
+	if (!ops || !ops->set_fb_base || !priv->pan_size || priv->rot ||
+	    priv->fb_fixed)
+		return -ENOSYS;
+	if (lines <= 0 || lines >= priv->ysize)
+		return -EINVAL;
+
+	/* Pending changes are relative to the current start address */
+	video_flush_damage(priv);
+
+	if (priv->fb + step + priv->fb_size >
+	    priv->pan_base + priv->pan_size) {
+		memmove(priv->pan_base, priv->fb + step, priv->fb_size - step);
+		priv->fb = priv->pan_base;
+		video_damage(vid, 0, priv->ysize);
+	} else {
+		priv->fb += step;
+	}
+	video_fill(priv, priv->ysize - lines, lines);
+	video_damage(vid, priv->ysize - lines, lines);
+	video_sync(vid);
+
+	return ops->set_fb_base(vid, priv->fb);
 }
 
 void video_sync_all(void)
@@ -204,6 +289,10 @@ static int video_post_probe(struct udevice *dev)
 	priv->fb = map_sysmem(plat->base, plat->size);
 	priv->line_length = priv->xsize * VNBYTES(priv->bpix);
 	priv->fb_size = priv->line_length * priv->ysize;
+	priv->pan_base = priv->fb;
+	if (priv->pan_size > plat->size ||
+	    priv->pan_size < priv->fb_size + priv->line_length)
+		priv->pan_size = 0;
 
 	/* Set up colours - we could in future support other colours */
 #ifdef CONFIG_SYS_WHITE_ON_BLACK
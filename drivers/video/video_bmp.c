@@ -260,6 +260,8 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 	if ((y + height) > priv->ysize)
 		height = priv->ysize - y;
 
+	video_damage(dev, y, height);
+
 	bmap = (uchar *)bmp + get_unaligned_le32(&bmp->header.data_offset);
 	fb = (uchar *)(priv->fb +
 		(y + height - 1) * priv->line_length + x * bpix / 8);
@@ -1958,6 +1958,210 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
 	return blknr;
 }
 
+#define EXT4FS_RUNS_CACHED	4
+#define EXT4FS_EXTENT_MAX_DEPTH	5
+
+/* Block runs of recently read files, so repeated loads skip the mapping */
+struct ext4fs_runs_cache {
+	struct blk_desc *dev_desc;
+	lbaint_t part_offset;
+	int ino;
+	uint32_t size;
+	uint32_t mtime;
+	uint32_t ctime;
+	struct ext4fs_run *runs;
+	int nr_runs;
+};
+
+static struct ext4fs_runs_cache ext4fs_runs_cache[EXT4FS_RUNS_CACHED];
+static int ext4fs_runs_victim;
+
+struct ext4fs_run_list {
+	struct ext4fs_run *runs;
+	int nr;
+	int max;
+};
+
+/* Append a mapping, merging it with the last run when contiguous */
+static int ext4fs_add_run(struct ext4fs_run_list *list, uint32_t lblk,
+			  uint64_t pblk, uint32_t len)
+{
+	struct ext4fs_run *run;
+
+	if (!len || !pblk)
+		return 0;
+
+	if (list->nr) {
+		run = &list->runs[list->nr - 1];
+		if (run->lblk + run->len == lblk &&
+		    run->pblk + run->len == pblk) {
+			run->len += len;
+			return 0;
+		}
+	}
+
+	if (list->nr == list->max) {
+		int max = list->max ? list->max * 2 : 16;
+
+		run = realloc(list->runs, max * sizeof(*run));
+		if (!run)
+			return -ENOMEM;
+		list->runs = run;
+		list->max = max;
+	}
+
+	run = &list->runs[list->nr++];
+	run->lblk = lblk;
+	run->pblk = pblk;
+	run->len = len;
+
+	return 0;
+}
+
+static int ext4fs_collect_extents(struct ext4_extent_header *ext_block,
+				  struct ext4fs_run_list *list, int log2_blksz,
+				  int depth)
+{
+	int blksz = EXT2_BLOCK_SIZE(ext4fs_root);
+	int entries = le16_to_cpu(ext_block->eh_entries);
+	unsigned long long block;
+	int i, ret;
+
+	if (le16_to_cpu(ext_block->eh_magic) != EXT4_EXT_MAGIC ||
+	    depth > EXT4FS_EXTENT_MAX_DEPTH)
+		return -EINVAL;
+
+	if (ext_block->eh_depth == 0) {
+		struct ext4_extent *extent;
+
+		extent = (struct ext4_extent *)(ext_block + 1);
+		for (i = 0; i < entries; i++) {
+			uint16_t len = le16_to_cpu(extent[i].ee_len);
+
+			/* Uninitialized extents read back as zeroes */
+			if (len > EXT_INIT_MAX_LEN)
+				continue;
+			block = le16_to_cpu(extent[i].ee_start_hi);
+			block = (block << 32) +
+				le32_to_cpu(extent[i].ee_start_lo);
+			ret = ext4fs_add_run(list,
+					     le32_to_cpu(extent[i].ee_block),
+					     block, len);
+			if (ret)
+				return ret;
+		}
+
+		return 0;
+	} else {
+		struct ext4_extent_idx *index;
+		char *buf;
+
+		buf = zalloc(blksz);
+		if (!buf)
+			return -ENOMEM;
+
+		index = (struct ext4_extent_idx *)(ext_block + 1);
+		for (i = 0; i < entries; i++) {
+			block = le16_to_cpu(index[i].ei_leaf_hi);
+			block = (block << 32) +
+				le32_to_cpu(index[i].ei_leaf_lo);
+			if (!ext4fs_devread((lbaint_t)block << log2_blksz, 0,
+					    blksz, buf)) {
+				ret = -EIO;
+				break;
+			}
+			ret = ext4fs_collect_extents(
+				(struct ext4_extent_header *)buf, list,
+				log2_blksz, depth + 1);
+			if (ret)
+				break;
+		}
+		free(buf);
+
+		return ret;
+	}
+}
+
+void ext4fs_runs_invalidate(void)
+{
+	int i;
+
+	for (i = 0; i < EXT4FS_RUNS_CACHED; i++) {
+		free(ext4fs_runs_cache[i].runs);
+		memset(&ext4fs_runs_cache[i], 0, sizeof(ext4fs_runs_cache[i]));
+	}
+}
+
+int ext4fs_get_runs(struct ext2fs_node *node, struct ext4fs_run **runsp)
+{
+	struct ext2_inode *inode = &node->inode;
+	struct ext_filesystem *fs = get_fs();
+	struct ext4fs_runs_cache *cache;
+	struct ext4fs_run_list list = { 0 };
+	int log2_blksz;
+	int i, ret = 0;
+
+	for (i = 0; i < EXT4FS_RUNS_CACHED; i++) {
+		cache = &ext4fs_runs_cache[i];
+		if (cache->runs && cache->dev_desc == fs->dev_desc &&
+		    cache->part_offset == part_offset &&
+		    cache->ino == node->ino &&
+		    cache->size == le32_to_cpu(inode->size) &&
+		    cache->mtime == le32_to_cpu(inode->mtime) &&
+		    cache->ctime == le32_to_cpu(inode->ctime)) {
+			*runsp = cache->runs;
+			return cache->nr_runs;
+		}
+	}
+
+	log2_blksz = LOG2_BLOCK_SIZE(ext4fs_root) - fs->dev_desc->log2blksz;
+	if (le32_to_cpu(inode->flags) & EXT4_EXTENTS_FL) {
+		ret = ext4fs_collect_extents((struct ext4_extent_header *)
+					     inode->b.blocks.dir_blocks,
+					     &list, log2_blksz, 0);
+	} else {
+		uint32_t blocks = DIV_ROUND_UP(le32_to_cpu(inode->size),
+					       EXT2_BLOCK_SIZE(ext4fs_root));
+		long int blknr;
+
+		for (i = 0; i < blocks && !ret; i++) {
+			blknr = read_allocated_block(inode, i);
+			if (blknr < 0)
+				ret = -EIO;
+			else
+				ret = ext4fs_add_run(&list, i, blknr, 1);
+		}
+	}
+
+	if (ret) {
+		free(list.runs);
+		return ret;
+	}
+
+	/* Keep an empty (fully sparse) list distinguishable from a miss */
+	if (!list.runs) {
+		list.runs = malloc(sizeof(*list.runs));
+		if (!list.runs)
+			return -ENOMEM;
+	}
+
+	cache = &ext4fs_runs_cache[ext4fs_runs_victim];
+	ext4fs_runs_victim = (ext4fs_runs_victim + 1) % EXT4FS_RUNS_CACHED;
+	free(cache->runs);
+	cache->dev_desc = fs->dev_desc;
+	cache->part_offset = part_offset;
+	cache->ino = node->ino;
+	cache->size = le32_to_cpu(inode->size);
+	cache->mtime = le32_to_cpu(inode->mtime);
+	cache->ctime = le32_to_cpu(inode->ctime);
+	cache->runs = list.runs;
+	cache->nr_runs = list.nr;
+
+	*runsp = list.runs;
+
+	return list.nr;
+}
+
 /**
  * ext4fs_reinit_global() - Reinitialize values of ext4 write implementation's
  *			    global pointers
@@ -2005,36 +2209,46 @@ void ext4fs_close(void)
 	ext4fs_reinit_global();
 }
 
-int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
-				struct ext2fs_node **fnode, int *ftype)
+/*
+ * Walk the directory entries in [fpos, end). The directory is read one
+ * filesystem block at a time; entries never cross a block boundary.
+ */
+static int ext4fs_iterate_dir_range(struct ext2fs_node *diro, char *name,
+				    struct ext2fs_node **fnode, int *ftype,
+				    unsigned int fpos, unsigned int end)
 {
-	unsigned int fpos = 0;
-	int status;
+	unsigned int blksz = EXT2_BLOCK_SIZE(diro->data);
+	unsigned int blkpos = -1;
+	int status, ret = 0;
 	loff_t actread;
-	struct ext2fs_node *diro = (struct ext2fs_node *) dir;
+	char *blkbuf;
+
+	blkbuf = zalloc(blksz);
+	if (!blkbuf)
+		return 0;
 
-#ifdef DEBUG
-	if (name != NULL)
-		printf("Iterate dir %s\n", name);
-#endif /* of DEBUG */
-	if (!diro->inode_read) {
-		status = ext4fs_read_inode(diro->data, diro->ino, &diro->inode);
-		if (status == 0)
-			return 0;
-	}
 	/* Search the file.  */
-	while (fpos < le32_to_cpu(diro->inode.size)) {
+	while (fpos < end) {
 		struct ext2_dirent dirent;
+		unsigned int off = fpos % blksz;
 
-		status = ext4fs_read_file(diro, fpos,
-					   sizeof(struct ext2_dirent),
-					   (char *)&dirent, &actread);
-		if (status < 0)
-			return 0;
+		if (fpos - off != blkpos) {
+			blkpos = fpos - off;
+			status = ext4fs_read_file(diro, blkpos, blksz, blkbuf,
+						  &actread);
+			if (status < 0)
+				goto out;
+		}
 
-		if (dirent.direntlen == 0) {
+		if (off + sizeof(struct ext2_dirent) > blksz)
+			dirent.direntlen = 0;
+		else
+			memcpy(&dirent, blkbuf + off, sizeof(dirent));
+
+		if (dirent.direntlen == 0 ||
+		    off + sizeof(struct ext2_dirent) + dirent.namelen > blksz) {
 			printf("Failed to iterate over directory %s\n", name);
-			return 0;
+			goto out;
 		}
 
 		if (dirent.namelen != 0) {
@@ -2042,17 +2256,12 @@ int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 			struct ext2fs_node *fdiro;
 			int type = FILETYPE_UNKNOWN;
 
-			status = ext4fs_read_file(diro,
-						  fpos +
-						  sizeof(struct ext2_dirent),
-						  dirent.namelen, filename,
-						  &actread);
-			if (status < 0)
-				return 0;
+			memcpy(filename, blkbuf + off + sizeof(dirent),
+			       dirent.namelen);
 
 			fdiro = zalloc(sizeof(struct ext2fs_node));
 			if (!fdiro)
-				return 0;
+				goto out;
 
 			fdiro->data = diro->data;
 			fdiro->ino = le32_to_cpu(dirent.inode);
@@ -2075,7 +2284,7 @@ int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 							   &fdiro->inode);
 				if (status == 0) {
 					free(fdiro);
-					return 0;
+					goto out;
 				}
 				fdiro->inode_read = 1;
 
@@ -2101,7 +2310,8 @@ int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 				if (strcmp(filename, name) == 0) {
 					*ftype = type;
 					*fnode = fdiro;
-					return 1;
+					ret = 1;
+					goto out;
 				}
 			} else {
 				if (fdiro->inode_read == 0) {
@@ -2111,7 +2321,7 @@ int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 								 &fdiro->inode);
 					if (status == 0) {
 						free(fdiro);
-						return 0;
+						goto out;
 					}
 					fdiro->inode_read = 1;
 				}
@@ -2137,7 +2347,56 @@ int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 		}
 		fpos += le16_to_cpu(dirent.direntlen);
 	}
-	return 0;
+out:
+	free(blkbuf);
+
+	return ret;
+}
+
+#define EXT4FS_HTREE_MAX_LEAVES	8
+
+int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
+				struct ext2fs_node **fnode, int *ftype)
+{
+	struct ext2fs_node *diro = (struct ext2fs_node *) dir;
+	u32 leaves[EXT4FS_HTREE_MAX_LEAVES];
+	unsigned int blksz;
+	int status, i, n;
+
+#ifdef DEBUG
+	if (name != NULL)
+		printf("Iterate dir %s\n", name);
+#endif /* of DEBUG */
+	if (!diro->inode_read) {
+		status = ext4fs_read_inode(diro->data, diro->ino, &diro->inode);
+		if (status == 0)
+			return 0;
+	}
+
+	/*
+	 * Lookups in an indexed directory only need the leaf blocks the
+	 * name hashes to. Anything unexpected falls back to a linear scan.
+	 */
+	if (name && fnode && ftype) {
+		n = ext4fs_htree_lookup(diro, name, leaves, ARRAY_SIZE(leaves));
+		if (n >= 0) {
+			blksz = EXT2_BLOCK_SIZE(diro->data);
+			for (i = 0; i < n; i++) {
+				if (ext4fs_iterate_dir_range(diro, name, fnode,
+							     ftype,
+							     leaves[i] * blksz,
+							     (leaves[i] + 1) *
+							     blksz))
+					return 1;
+			}
+			return 0;
+		}
+		debug("%s: htree lookup of %s failed (%d), scanning\n",
+		      __func__, name, n);
+	}
+
+	return ext4fs_iterate_dir_range(diro, name, fnode, ftype, 0,
+					le32_to_cpu(diro->inode.size));
 }
 
 static char *ext4fs_read_symlink(struct ext2fs_node *node)
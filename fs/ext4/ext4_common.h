@@ -48,14 +48,46 @@ static inline void *zalloc(size_t size)
 	return p;
 }
 
+/* A contiguous range of file blocks */
+struct ext4fs_run {
+	uint32_t lblk;		/* first logical block in the file */
+	uint32_t len;		/* number of filesystem blocks */
+	uint64_t pblk;		/* first physical filesystem block */
+};
+
 int ext4fs_read_inode(struct ext2_data *data, int ino,
 		      struct ext2_inode *inode);
+/**
+ * ext4fs_get_runs() - Map a file to its contiguous block runs
+ *
+ * The extent tree (or indirect block map) is walked once and adjacent
+ * mappings are merged. Holes are not listed. The result is cached, keyed
+ * by device, partition and inode, so it must not be freed by the caller.
+ *
+ * @node:	File to map, with the inode already read
+ * @runsp:	Returns the runs, sorted by logical block
+ * @return number of runs, or -ve on error
+ */
+int ext4fs_get_runs(struct ext2fs_node *node, struct ext4fs_run **runsp);
+void ext4fs_runs_invalidate(void);
 int ext4fs_read_file(struct ext2fs_node *node, loff_t pos, loff_t len,
 		     char *buf, loff_t *actread);
 int ext4fs_find_file(const char *path, struct ext2fs_node *rootnode,
 			struct ext2fs_node **foundnode, int expecttype);
 int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 			struct ext2fs_node **fnode, int *ftype);
+/**
+ * ext4fs_htree_lookup() - Find the leaf blocks of an indexed directory
+ *
+ * @dir:	Directory with EXT4_INDEX_FL set and its inode read
+ * @name:	Name to look up
+ * @blocks:	Returns the logical directory blocks which may hold @name
+ * @max:	Size of @blocks
+ * @return number of blocks, or -ve if the index can not be used, in
+ * which case the directory must be scanned linearly
+ */
+int ext4fs_htree_lookup(struct ext2fs_node *dir, const char *name,
+			u32 *blocks, int max);
 
 #if defined(CONFIG_EXT4_WRITE)
 uint32_t ext4fs_div_roundup(uint32_t size, uint32_t n);
@@ -0,0 +1,341 @@
+/*
+ * (C) Copyright 2020 Rockchip Electronics Co., Ltd
+ *
+ * Hashed directory (dir_index / htree) lookup for ext3/ext4.
+ *
+ * The hash functions are taken from Linux fs/ext4/hash.c:
+ * Copyright (C) 2002 by Theodore Ts'o
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <ext_common.h>
+#include <ext4fs.h>
+#include "ext4_common.h"
+
+#define DX_HASH_LEGACY			0
+#define DX_HASH_HALF_MD4		1
+#define DX_HASH_TEA			2
+#define DX_HASH_LEGACY_UNSIGNED		3
+#define DX_HASH_HALF_MD4_UNSIGNED	4
+#define DX_HASH_TEA_UNSIGNED		5
+
+#define EXT2_FLAGS_UNSIGNED_HASH	0x0002
+#define EXT4_HTREE_EOF_32BIT		0x7fffffff
+#define EXT4_HTREE_MAX_LEVELS		3
+
+struct dx_root_info {
+	__le32 reserved_zero;
+	__u8 hash_version;
+	__u8 info_length;	/* 8 */
+	__u8 indirect_levels;
+	__u8 unused_flags;
+};
+
+struct dx_entry {
+	__le32 hash;
+	__le32 block;
+};
+
+/* Overlays the hash of the first dx_entry of a node */
+struct dx_countlimit {
+	__le16 limit;
+	__le16 count;
+};
+
+#define DELTA 0x9E3779B9
+
+static void tea_transform(u32 buf[4], u32 const in[])
+{
+	u32 sum = 0;
+	u32 b0 = buf[0], b1 = buf[1];
+	u32 a = in[0], b = in[1], c = in[2], d = in[3];
+	int n = 16;
+
+	do {
+		sum += DELTA;
+		b0 += ((b1 << 4) + a) ^ (b1 + sum) ^ ((b1 >> 5) + b);
+		b1 += ((b0 << 4) + c) ^ (b0 + sum) ^ ((b0 >> 5) + d);
+	} while (--n);
+
+	buf[0] += b0;
+	buf[1] += b1;
+}
+
+/* F, G and H are basic MD4 functions: selection, majority, parity */
+#define F(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define G(x, y, z) (((x) & (y)) + (((x) ^ (y)) & (z)))
+#define H(x, y, z) ((x) ^ (y) ^ (z))
+
+#define ROL32(x, s) (((x) << (s)) | ((x) >> (32 - (s))))
+#define MD4_ROUND(f, a, b, c, d, x, s)	\
+	(a += f(b, c, d) + x, a = ROL32(a, s))
+#define K1 0
+#define K2 013240474631UL
+#define K3 015666365641UL
+
+static void half_md4_transform(u32 buf[4], u32 const in[8])
+{
+	u32 a = buf[0], b = buf[1], c = buf[2], d = buf[3];
+
+	/* Round 1 */
+	MD4_ROUND(F, a, b, c, d, in[0] + K1,  3);
+	MD4_ROUND(F, d, a, b, c, in[1] + K1,  7);
+	MD4_ROUND(F, c, d, a, b, in[2] + K1, 11);
+	MD4_ROUND(F, b, c, d, a, in[3] + K1, 19);
+	MD4_ROUND(F, a, b, c, d, in[4] + K1,  3);
+	MD4_ROUND(F, d, a, b, c, in[5] + K1,  7);
+	MD4_ROUND(F, c, d, a, b, in[6] + K1, 11);
+	MD4_ROUND(F, b, c, d, a, in[7] + K1, 19);
+
+	/* Round 2 */
+	MD4_ROUND(G, a, b, c, d, in[1] + K2,  3);
+	MD4_ROUND(G, d, a, b, c, in[3] + K2,  5);
+	MD4_ROUND(G, c, d, a, b, in[5] + K2,  9);
+	MD4_ROUND(G, b, c, d, a, in[7] + K2, 13);
+	MD4_ROUND(G, a, b, c, d, in[0] + K2,  3);
+	MD4_ROUND(G, d, a, b, c, in[2] + K2,  5);
+	MD4_ROUND(G, c, d, a, b, in[4] + K2,  9);
+	MD4_ROUND(G, b, c, d, a, in[6] + K2, 13);
+
+	/* Round 3 */
+	MD4_ROUND(H, a, b, c, d, in[3] + K3,  3);
+	MD4_ROUND(H, d, a, b, c, in[7] + K3,  9);
+	MD4_ROUND(H, c, d, a, b, in[2] + K3, 11);
+	MD4_ROUND(H, b, c, d, a, in[6] + K3, 15);
+	MD4_ROUND(H, a, b, c, d, in[1] + K3,  3);
+	MD4_ROUND(H, d, a, b, c, in[5] + K3,  9);
+	MD4_ROUND(H, c, d, a, b, in[0] + K3, 11);
+	MD4_ROUND(H, b, c, d, a, in[4] + K3, 15);
+
+	buf[0] += a;
+	buf[1] += b;
+	buf[2] += c;
+	buf[3] += d;
+}
+
+/* The old legacy hash */
+static u32 dx_hack_hash(const char *name, int len, bool is_unsigned)
+{
+	u32 hash, hash0 = 0x12a3fe2d, hash1 = 0x37abe8f9;
+	int c;
+
+	while (len--) {
+		c = is_unsigned ? (int)(unsigned char)*name :
+				  (int)(signed char)*name;
+		name++;
+		hash = hash1 + (hash0 ^ (c * 7152373));
+
+		if (hash & 0x80000000)
+			hash -= 0x7fffffff;
+		hash1 = hash0;
+		hash0 = hash;
+	}
+
+	return hash0 << 1;
+}
+
+static void str2hashbuf(const char *msg, int len, u32 *buf, int num,
+			bool is_unsigned)
+{
+	u32 pad, val;
+	int i, c;
+
+	pad = (u32)len | ((u32)len << 8);
+	pad |= pad << 16;
+
+	val = pad;
+	if (len > num * 4)
+		len = num * 4;
+	for (i = 0; i < len; i++) {
+		c = is_unsigned ? (int)(unsigned char)msg[i] :
+				  (int)(signed char)msg[i];
+		val = c + (val << 8);
+		if ((i % 4) == 3) {
+			*buf++ = val;
+			val = pad;
+			num--;
+		}
+	}
+	if (--num >= 0)
+		*buf++ = val;
+	while (--num >= 0)
+		*buf++ = pad;
+}
+
+static int ext4fs_dirhash(const char *name, int len, int version,
+			  const __le32 *seed, u32 *hashp)
+{
+	u32 buf[4], in[8];
+	bool is_unsigned = version >= DX_HASH_LEGACY_UNSIGNED;
+	u32 hash;
+	int i;
+
+	buf[0] = 0x67452301;
+	buf[1] = 0xefcdab89;
+	buf[2] = 0x98badcfe;
+	buf[3] = 0x10325476;
+
+	for (i = 0; i < 4; i++) {
+		if (seed[i]) {
+			for (i = 0; i < 4; i++)
+				buf[i] = le32_to_cpu(seed[i]);
+			break;
+		}
+	}
+
+	switch (version) {
+	case DX_HASH_LEGACY:
+	case DX_HASH_LEGACY_UNSIGNED:
+		hash = dx_hack_hash(name, len, is_unsigned);
+		break;
+	case DX_HASH_HALF_MD4:
+	case DX_HASH_HALF_MD4_UNSIGNED:
+		while (len > 0) {
+			str2hashbuf(name, len, in, 8, is_unsigned);
+			half_md4_transform(buf, in);
+			len -= 32;
+			name += 32;
+		}
+		hash = buf[1];
+		break;
+	case DX_HASH_TEA:
+	case DX_HASH_TEA_UNSIGNED:
+		while (len > 0) {
+			str2hashbuf(name, len, in, 4, is_unsigned);
+			tea_transform(buf, in);
+			len -= 16;
+			name += 16;
+		}
+		hash = buf[0];
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	hash &= ~1;
+	if (hash == (EXT4_HTREE_EOF_32BIT << 1))
+		hash = (EXT4_HTREE_EOF_32BIT - 1) << 1;
+	*hashp = hash;
+
+	return 0;
+}
+
+static int ext4fs_read_dir_block(struct ext2fs_node *dir, u32 lblk, char *buf)
+{
+	int blksz = EXT2_BLOCK_SIZE(dir->data);
+	loff_t actread;
+
+	if (ext4fs_read_file(dir, (loff_t)lblk * blksz, blksz, buf,
+			     &actread) < 0 || actread != blksz)
+		return -EIO;
+
+	return 0;
+}
+
+int ext4fs_htree_lookup(struct ext2fs_node *dir, const char *name,
+			u32 *blocks, int max)
+{
+	struct ext2_sblock *sblock = &dir->data->sblock;
+	int blksz = EXT2_BLOCK_SIZE(dir->data);
+	struct dx_root_info *info;
+	struct dx_countlimit *cl;
+	struct dx_entry *entries;
+	int version, levels, count, level, lo, hi, i, n = 0;
+	u32 hash, next_hash = 0;
+	char *buf;
+	int ret;
+
+	if (!(le32_to_cpu(dir->inode.flags) & EXT4_INDEX_FL))
+		return -ENOTSUPP;
+
+	buf = zalloc(blksz);
+	if (!buf)
+		return -ENOMEM;
+
+	/* The root lives behind the "." and ".." entries of block 0 */
+	ret = ext4fs_read_dir_block(dir, 0, buf);
+	if (ret)
+		goto out;
+
+	info = (struct dx_root_info *)(buf + 24);
+	version = info->hash_version;
+	levels = info->indirect_levels;
+	if (info->reserved_zero || info->info_length != 8 ||
+	    levels >= EXT4_HTREE_MAX_LEVELS || version > DX_HASH_TEA) {
+		ret = -ENOTSUPP;
+		goto out;
+	}
+	if (le32_to_cpu(sblock->flags) & EXT2_FLAGS_UNSIGNED_HASH)
+		version += DX_HASH_LEGACY_UNSIGNED;
+
+	ret = ext4fs_dirhash(name, strlen(name), version, sblock->hash_seed,
+			     &hash);
+	if (ret)
+		goto out;
+
+	entries = (struct dx_entry *)((char *)info + info->info_length);
+	for (level = 0; ; level++) {
+		cl = (struct dx_countlimit *)entries;
+		count = le16_to_cpu(cl->count);
+		if (!count || count > le16_to_cpu(cl->limit) ||
+		    (char *)&entries[count] > buf + blksz) {
+			ret = -EINVAL;
+			goto out;
+		}
+
+		/* Last entry whose hash is <= ours; entry 0 covers from 0 */
+		lo = 1;
+		hi = count - 1;
+		while (lo <= hi) {
+			int mid = (lo + hi) / 2;
+
+			if (le32_to_cpu(entries[mid].hash) > hash)
+				hi = mid - 1;
+			else
+				lo = mid + 1;
+		}
+		i = lo - 1;
+
+		if (level == levels)
+			break;
+
+		/* Remember where the next node starts, for collisions */
+		if (i + 1 < count)
+			next_hash = le32_to_cpu(entries[i + 1].hash);
+
+		ret = ext4fs_read_dir_block(dir, le32_to_cpu(entries[i].block) &
+					    0x0fffffff, buf);
+		if (ret)
+			goto out;
+		/* Interior nodes start with an empty fake dirent */
+		entries = (struct dx_entry *)(buf + 8);
+	}
+
+	/*
+	 * Leaf candidates: the block found plus the following ones as long
+	 * as they continue a hash collision (low bit of their hash set).
+	 */
+	do {
+		if (n == max) {
+			ret = -E2BIG;
+			goto out;
+		}
+		blocks[n++] = le32_to_cpu(entries[i].block) & 0x0fffffff;
+		i++;
+	} while (i < count && (le32_to_cpu(entries[i].hash) & 1) &&
+		 (le32_to_cpu(entries[i].hash) & ~1) == hash);
+
+	/* A collision chain running into the next node: let the caller scan */
+	if (i == count && (next_hash & 1) && (next_hash & ~1) == hash) {
+		ret = -E2BIG;
+		goto out;
+	}
+
+	ret = n;
+out:
+	free(buf);
+
+	return ret;
+}
@@ -23,6 +23,7 @@
 
 
 #include <common.h>
+#include <fs.h>
 #include <memalign.h>
 #include <linux/stat.h>
 #include <div64.h>
@@ -865,6 +866,8 @@ int ext4fs_write(const char *fname, unsigned char *buffer,
 		printf("error in File System init\n");
 		return -1;
 	}
+	ext4fs_runs_invalidate();
+	fs_dcache_invalidate();
 	inodes_per_block = fs->blksz / fs->inodesz;
 	parent_inodeno = ext4fs_get_parent_inode_num(fname, filename, F_FILE);
 	if (parent_inodeno == -1)
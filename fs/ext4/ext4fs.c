@@ -25,7 +25,9 @@
 #include <ext_common.h>
 #include <ext4fs.h>
 #include "ext4_common.h"
+#include <blk.h>
 #include <div64.h>
+#include <linux/sizes.h>
 
 int ext4fs_symlinknest;
 struct ext_filesystem ext_fs;
@@ -42,27 +44,21 @@ void ext4fs_free_node(struct ext2fs_node *node, struct ext2fs_node *currroot)
 }
 
 /*
- * Taken from openmoko-kernel mailing list: By Andy green
- * Optimized read file API : collects and defers contiguous sector
- * reads into one potentially more efficient larger sequential read action
+ * Read a file range run by run: the block map comes from ext4fs_get_runs()
+ * (resolved once and cached), each contiguous run is a single device read
+ * and holes are zero-filled.
  */
 int ext4fs_read_file(struct ext2fs_node *node, loff_t pos,
 		loff_t len, char *buf, loff_t *actread)
 {
 	struct ext_filesystem *fs = get_fs();
-	int i;
-	lbaint_t blockcnt;
 	int log2blksz = fs->dev_desc->log2blksz;
 	int log2_fs_blocksize = LOG2_BLOCK_SIZE(node->data) - log2blksz;
 	int blocksize = (1 << (log2_fs_blocksize + log2blksz));
 	unsigned int filesize = le32_to_cpu(node->inode.size);
-	lbaint_t previous_block_number = -1;
-	lbaint_t delayed_start = 0;
-	lbaint_t delayed_extent = 0;
-	lbaint_t delayed_skipfirst = 0;
-	lbaint_t delayed_next = 0;
-	char *delayed_buf = NULL;
-	short status;
+	struct ext4fs_run *runs;
+	loff_t done, end;
+	int nr_runs, i;
 
 	if (blocksize <= 0)
 		return -1;
@@ -71,94 +67,61 @@ int ext4fs_read_file(struct ext2fs_node *node, loff_t pos,
 	if (len + pos > filesize)
 		len = (filesize - pos);
 
-	blockcnt = lldiv(((len + pos) + blocksize - 1), blocksize);
-
-	for (i = lldiv(pos, blocksize); i < blockcnt; i++) {
-		long int blknr;
-		int blockoff = pos - (blocksize * i);
-		int blockend = blocksize;
-		int skipfirst = 0;
-		blknr = read_allocated_block(&(node->inode), i);
-		if (blknr < 0)
-			return -1;
+	nr_runs = ext4fs_get_runs(node, &runs);
+	if (nr_runs < 0)
+		return -1;
 
-		blknr = blknr << log2_fs_blocksize;
+	end = pos + len;
 
-		/* Last block.  */
-		if (i == blockcnt - 1) {
-			blockend = (len + pos) - (blocksize * i);
+	/* Tell the block layer what is coming so it can read ahead */
+	for (i = 0; i < nr_runs; i++) {
+		loff_t rstart = (loff_t)runs[i].lblk * blocksize;
+		loff_t rend = rstart + (loff_t)runs[i].len * blocksize;
 
-			/* The last portion is exactly blocksize. */
-			if (!blockend)
-				blockend = blocksize;
-		}
+		if (rend <= pos || rstart >= end)
+			continue;
+		blk_prefetch(fs->dev_desc, part_offset +
+			     ((lbaint_t)runs[i].pblk << log2_fs_blocksize),
+			     (lbaint_t)runs[i].len << log2_fs_blocksize);
+	}
 
-		/* First block. */
-		if (i == lldiv(pos, blocksize)) {
-			skipfirst = blockoff;
-			blockend -= skipfirst;
+	done = pos;
+	for (i = 0; i < nr_runs && done < end; i++) {
+		loff_t rstart = (loff_t)runs[i].lblk * blocksize;
+		loff_t rend = rstart + (loff_t)runs[i].len * blocksize;
+		loff_t from, to;
+
+		if (rend <= done)
+			continue;
+		if (rstart >= end)
+			break;
+
+		from = max(rstart, done);
+		to = min(rend, end);
+
+		/* Sparse part before this run */
+		if (from > done)
+			memset(buf + (done - pos), 0, from - done);
+
+		while (from < to) {
+			loff_t off = from - rstart;
+			int chunk = min_t(loff_t, to - from, SZ_1G);
+			lbaint_t sector;
+
+			sector = ((lbaint_t)runs[i].pblk << log2_fs_blocksize) +
+				 (off >> log2blksz);
+			if (!ext4fs_devread(sector, off & ((1 << log2blksz) - 1),
+					    chunk, buf + (from - pos)))
+				return -1;
+			from += chunk;
 		}
-		if (blknr) {
-			int status;
-
-			if (previous_block_number != -1) {
-				if (delayed_next == blknr) {
-					delayed_extent += blockend;
-					delayed_next += blockend >> log2blksz;
-				} else {	/* spill */
-					status = ext4fs_devread(delayed_start,
-							delayed_skipfirst,
-							delayed_extent,
-							delayed_buf);
-					if (status == 0)
-						return -1;
-					previous_block_number = blknr;
-					delayed_start = blknr;
-					delayed_extent = blockend;
-					delayed_skipfirst = skipfirst;
-					delayed_buf = buf;
-					delayed_next = blknr +
-						(blockend >> log2blksz);
-				}
-			} else {
-				previous_block_number = blknr;
-				delayed_start = blknr;
-				delayed_extent = blockend;
-				delayed_skipfirst = skipfirst;
-				delayed_buf = buf;
-				delayed_next = blknr +
-					(blockend >> log2blksz);
-			}
-		} else {
-			int n;
-			if (previous_block_number != -1) {
-				/* spill */
-				status = ext4fs_devread(delayed_start,
-							delayed_skipfirst,
-							delayed_extent,
-							delayed_buf);
-				if (status == 0)
-					return -1;
-				previous_block_number = -1;
-			}
-			/* Zero no more than `len' bytes. */
-			n = blocksize - skipfirst;
-			if (n > len)
-				n = len;
-			memset(buf, 0, n);
-		}
-		buf += blocksize - skipfirst;
-	}
-	if (previous_block_number != -1) {
-		/* spill */
-		status = ext4fs_devread(delayed_start,
-					delayed_skipfirst, delayed_extent,
-					delayed_buf);
-		if (status == 0)
-			return -1;
-		previous_block_number = -1;
+		done = to;
 	}
 
+	/* Sparse tail */
+	if (done < end)
+		memset(buf + (done - pos), 0, end - done);
+
 	*actread  = len;
 	return 0;
 }
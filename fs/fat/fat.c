@@ -12,6 +12,7 @@
 #include <common.h>
 #include <blk.h>
 #include <config.h>
+#include <div64.h>
 #include <exports.h>
 #include <fat.h>
 #include <fs.h>
@@ -63,10 +64,38 @@ static int disk_read(__u32 block, __u32 nr_blocks, void *buf)
 	return ret;
 }
 
+/* A contiguous range of clusters in a file's chain */
+struct fat_run {
+	__u32 clust;
+	__u32 count;
+};
+
+/*
+ * Cluster map of the last file read, so that repeated reads of the same
+ * file (e.g. header then body) skip walking the FAT again. Dropped on
+ * every fat_set_blk_dev(), the medium may have changed underneath.
+ */
+static struct {
+	struct blk_desc *dev;
+	lbaint_t part_start;
+	__u32 start;
+	__u32 size;		/* file size, tells apart files reusing start */
+	__u32 clusters;		/* number of clusters mapped */
+	struct fat_run *runs;
+	int nr_runs;
+} fat_runs_cache;
+
+static void fat_runs_invalidate(void)
+{
+	free(fat_runs_cache.runs);
+	memset(&fat_runs_cache, 0, sizeof(fat_runs_cache));
+}
+
 int fat_set_blk_dev(struct blk_desc *dev_desc, disk_partition_t *info)
 {
 	ALLOC_CACHE_ALIGN_BUFFER(unsigned char, buffer, dev_desc->blksz);
 
+	fat_runs_invalidate();
 	cur_dev = dev_desc;
 	cur_part_info = *info;
 
@@ -315,14 +344,75 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
 __u8 get_contents_vfatname_block[MAX_CLUSTSIZE]
 	__aligned(ARCH_DMA_MINALIGN);
 
+/*
+ * Map the first @clusters clusters of the chain starting at @start, of a
+ * file of @size bytes, into contiguous runs. Returns the number of runs,
+ * which may cover fewer clusters if the chain ends early, or -1 on error.
+ */
+static int fat_get_runs(fsdata *mydata, __u32 start, __u32 size,
+			__u32 clusters, struct fat_run **runsp)
+{
+	struct fat_run *runs = NULL, *run = NULL;
+	int nr_runs = 0, max_runs = 0;
+	__u32 clust = start, mapped = 0;
+
+	if (fat_runs_cache.runs && fat_runs_cache.dev == cur_dev &&
+	    fat_runs_cache.part_start == cur_part_info.start &&
+	    fat_runs_cache.start == start && fat_runs_cache.size == size &&
+	    fat_runs_cache.clusters >= clusters) {
+		*runsp = fat_runs_cache.runs;
+		return fat_runs_cache.nr_runs;
+	}
+
+	while (mapped < clusters) {
+		if (CHECK_CLUST(clust, mydata->fatsize)) {
+			debug("curclust: 0x%x\n", clust);
+			printf("Invalid FAT entry\n");
+			break;
+		}
+
+		if (run && run->clust + run->count == clust) {
+			run->count++;
+		} else {
+			if (nr_runs == max_runs) {
+				max_runs = max_runs ? max_runs * 2 : 16;
+				run = realloc(runs, max_runs * sizeof(*runs));
+				if (!run) {
+					free(runs);
+					return -1;
+				}
+				runs = run;
+			}
+			run = &runs[nr_runs++];
+			run->clust = clust;
+			run->count = 1;
+		}
+
+		if (++mapped < clusters)
+			clust = get_fatent(mydata, clust);
+	}
+
+	fat_runs_invalidate();
+	fat_runs_cache.dev = cur_dev;
+	fat_runs_cache.part_start = cur_part_info.start;
+	fat_runs_cache.start = start;
+	fat_runs_cache.size = size;
+	fat_runs_cache.clusters = mapped;
+	fat_runs_cache.runs = runs;
+	fat_runs_cache.nr_runs = nr_runs;
+
+	*runsp = runs;
+	return nr_runs;
+}
+
 static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 			__u8 *buffer, loff_t maxsize, loff_t *gotsize)
 {
 	loff_t filesize = FAT2CPU32(dentptr->size);
 	unsigned int bytesperclust = mydata->clust_size * mydata->sect_size;
-	__u32 curclust = START(dentptr);
-	__u32 endclust, newclust;
-	loff_t actsize;
+	struct fat_run *runs;
+	int nr_runs, i;
+	loff_t actsize, skip;
 
 	*gotsize = 0;
 	debug("Filesize: %llu bytes\n", filesize);
@@ -337,92 +427,67 @@ static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 
 	debug("%llu bytes\n", filesize);
 
-	actsize = bytesperclust;
+	nr_runs = fat_get_runs(mydata, START(dentptr), FAT2CPU32(dentptr->size),
+			       DIV_ROUND_UP(filesize, bytesperclust), &runs);
+	if (nr_runs < 0)
+		return -1;
 
-	/* go to cluster at pos */
-	while (actsize <= pos) {
-		curclust = get_fatent(mydata, curclust);
-		if (CHECK_CLUST(curclust, mydata->fatsize)) {
-			debug("curclust: 0x%x\n", curclust);
-			debug("Invalid FAT entry\n");
-			return 0;
-		}
-		actsize += bytesperclust;
-	}
+	/* Let the block layer read ahead within the file */
+	for (i = 0; i < nr_runs; i++)
+		blk_prefetch(cur_dev, cur_part_info.start +
+			     clust_to_sect(mydata, runs[i].clust),
+			     (lbaint_t)runs[i].count * mydata->clust_size);
 
-	/* actsize > pos */
-	actsize -= bytesperclust;
-	filesize -= actsize;
-	pos -= actsize;
+	skip = pos;
+	filesize -= pos;
 
-	/* align to beginning of next cluster if any */
-	if (pos) {
-		actsize = min(filesize, (loff_t)bytesperclust);
-		if (get_cluster(mydata, curclust, get_contents_vfatname_block,
-				(int)actsize) != 0) {
-			printf("Error reading cluster\n");
-			return -1;
-		}
-		filesize -= actsize;
-		actsize -= pos;
-		memcpy(buffer, get_contents_vfatname_block + pos, actsize);
-		*gotsize += actsize;
-		if (!filesize)
-			return 0;
-		buffer += actsize;
+	for (i = 0; i < nr_runs && filesize > 0; i++) {
+		__u32 clust = runs[i].clust;
+		__u32 count = runs[i].count;
 
-		curclust = get_fatent(mydata, curclust);
-		if (CHECK_CLUST(curclust, mydata->fatsize)) {
-			debug("curclust: 0x%x\n", curclust);
-			debug("Invalid FAT entry\n");
-			return 0;
+		if (skip >= (loff_t)count * bytesperclust) {
+			skip -= (loff_t)count * bytesperclust;
+			continue;
 		}
-	}
 
-	actsize = bytesperclust;
-	endclust = curclust;
-
-	do {
-		/* search for consecutive clusters */
-		while (actsize < filesize) {
-			newclust = get_fatent(mydata, endclust);
-			if ((newclust - 1) != endclust)
-				goto getit;
-			if (CHECK_CLUST(newclust, mydata->fatsize)) {
-				debug("curclust: 0x%x\n", newclust);
-				debug("Invalid FAT entry\n");
-				return 0;
+		/* go to cluster at pos */
+		clust += lldiv(skip, bytesperclust);
+		count -= lldiv(skip, bytesperclust);
+		skip -= (loff_t)lldiv(skip, bytesperclust) * bytesperclust;
+
+		/* align to beginning of next cluster if any */
+		if (skip) {
+			actsize = min(filesize + skip, (loff_t)bytesperclust);
+			if (get_cluster(mydata, clust,
+					get_contents_vfatname_block,
+					(int)actsize) != 0) {
+				printf("Error reading cluster\n");
+				return -1;
 			}
-			endclust = newclust;
-			actsize += bytesperclust;
+			actsize -= skip;
+			memcpy(buffer, get_contents_vfatname_block + skip,
+			       actsize);
+			*gotsize += actsize;
+			buffer += actsize;
+			filesize -= actsize;
+			skip = 0;
+			clust++;
+			if (!--count)
+				continue;
 		}
 
-		/* get remaining bytes */
-		actsize = filesize;
-		if (get_cluster(mydata, curclust, buffer, (int)actsize) != 0) {
+		/* the whole run with a single read */
+		actsize = min(filesize, (loff_t)count * bytesperclust);
+		if (get_cluster(mydata, clust, buffer, actsize) != 0) {
 			printf("Error reading cluster\n");
 			return -1;
 		}
 		*gotsize += actsize;
-		return 0;
-getit:
-		if (get_cluster(mydata, curclust, buffer, (int)actsize) != 0) {
-			printf("Error reading cluster\n");
-			return -1;
-		}
-		*gotsize += (int)actsize;
-		filesize -= actsize;
 		buffer += actsize;
+		filesize -= actsize;
+	}
 
-		curclust = get_fatent(mydata, endclust);
-		if (CHECK_CLUST(curclust, mydata->fatsize)) {
-			debug("curclust: 0x%x\n", curclust);
-			printf("Invalid FAT entry\n");
-			return 0;
-		}
-		actsize = bytesperclust;
-		endclust = curclust;
-	} while (1);
+	return 0;
 }
 
 /*
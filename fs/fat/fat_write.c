@@ -10,6 +10,7 @@
 #include <command.h>
 #include <config.h>
 #include <fat.h>
+#include <fs.h>
 #include <asm/byteorder.h>
 #include <part.h>
 #include <linux/ctype.h>
@@ -917,6 +918,8 @@ static int do_fat_write(const char *filename, void *buffer, loff_t size,
 
 	*actwrite = size;
 	dir_curclust = 0;
+	fat_runs_invalidate();
+	fs_dcache_invalidate();
 
 	if (read_bootsectandvi(&bs, &volinfo, &mydata->fatsize)) {
 		debug("error: reading boot sector\n");
@@ -7,6 +7,7 @@
 #include <config.h>
 #include <errno.h>
 #include <common.h>
+#include <malloc.h>
 #include <mapmem.h>
 #include <part.h>
 #include <ext4fs.h>
@@ -25,6 +26,87 @@ static int fs_dev_part;
 static disk_partition_t fs_partition;
 static int fs_type = FS_TYPE_ANY;
 
+#ifdef CONFIG_FS_DENTRY_CACHE
+#define FS_DCACHE_ENTRIES	16
+
+/*
+ * Results of exists/size lookups on the current block device and
+ * partition. Distro boot probes the same paths with fs_exists(), fs_size()
+ * and fs_read() in a row, each of which resolves the full path again.
+ */
+struct fs_dcache_entry {
+	char *path;
+	int fstype;
+	int exists;		/* -1 if not looked up yet */
+	bool size_valid;
+	int size_ret;
+	loff_t size;
+};
+
+static struct fs_dcache_entry fs_dcache[FS_DCACHE_ENTRIES];
+static int fs_dcache_victim;
+static struct blk_desc *fs_dcache_desc;
+static disk_partition_t fs_dcache_part;
+
+void fs_dcache_invalidate(void)
+{
+	int i;
+
+	for (i = 0; i < FS_DCACHE_ENTRIES; i++) {
+		free(fs_dcache[i].path);
+		fs_dcache[i].path = NULL;
+	}
+}
+
+/* Called once a device is selected: drop everything if it changed */
+static void fs_dcache_set_dev(void)
+{
+	if (fs_dcache_desc == fs_dev_desc &&
+	    fs_dcache_part.start == fs_partition.start &&
+	    fs_dcache_part.size == fs_partition.size)
+		return;
+
+	fs_dcache_invalidate();
+	fs_dcache_desc = fs_dev_desc;
+	fs_dcache_part = fs_partition;
+}
+
+static struct fs_dcache_entry *fs_dcache_find(const char *filename,
+					      bool create)
+{
+	struct fs_dcache_entry *de;
+	int i;
+
+	/* Host and UBI filesystems do not go through the block layer */
+	if (!fs_dev_desc || !filename)
+		return NULL;
+
+	for (i = 0; i < FS_DCACHE_ENTRIES; i++) {
+		de = &fs_dcache[i];
+		if (de->path && de->fstype == fs_type &&
+		    !strcmp(de->path, filename))
+			return de;
+	}
+
+	if (!create)
+		return NULL;
+
+	de = &fs_dcache[fs_dcache_victim];
+	fs_dcache_victim = (fs_dcache_victim + 1) % FS_DCACHE_ENTRIES;
+	free(de->path);
+	de->path = strdup(filename);
+	if (!de->path)
+		return NULL;
+	de->fstype = fs_type;
+	de->exists = -1;
+	de->size_valid = false;
+
+	return de;
+}
+#else
+static inline void fs_dcache_set_dev(void) {}
+#endif
+
 static inline int fs_probe_unsupported(struct blk_desc *fs_dev_desc,
 				      disk_partition_t *fs_partition)
 {
@@ -286,6 +368,7 @@ int fs_set_blk_dev(const char *ifname, const char *dev_part_str, int fstype)
 		if (!info->probe(fs_dev_desc, &fs_partition)) {
 			fs_type = info->fstype;
 			fs_dev_part = part;
+			fs_dcache_set_dev();
 			return 0;
 		}
 	}
@@ -310,6 +393,7 @@ int fs_set_blk_dev_with_part(struct blk_desc *desc, int part)
 	for (i = 0, info = fstypes; i < ARRAY_SIZE(fstypes); i++, info++) {
 		if (!info->probe(fs_dev_desc, &fs_partition)) {
 			fs_type = info->fstype;
+			fs_dcache_set_dev();
 			return 0;
 		}
 	}
@@ -371,9 +455,22 @@ int fs_exists(const char *filename)
 	int ret;
 
 	struct fstype_info *info = fs_get_info(fs_type);
+#ifdef CONFIG_FS_DENTRY_CACHE
+	struct fs_dcache_entry *de = fs_dcache_find(filename, false);
+
+	if (de && de->exists >= 0) {
+		fs_close();
+		return de->exists;
+	}
+#endif
 
 	ret = info->exists(filename);
 
+#ifdef CONFIG_FS_DENTRY_CACHE
+	de = fs_dcache_find(filename, true);
+	if (de)
+		de->exists = ret;
+#endif
 	fs_close();
 
 	return ret;
@@ -384,9 +481,29 @@ int fs_size(const char *filename, loff_t *size)
 	int ret;
 
 	struct fstype_info *info = fs_get_info(fs_type);
+#ifdef CONFIG_FS_DENTRY_CACHE
+	struct fs_dcache_entry *de = fs_dcache_find(filename, false);
+
+	if (de && de->size_valid) {
+		*size = de->size;
+		fs_close();
+		return de->size_ret;
+	}
+#endif
 
 	ret = info->size(filename, size);
 
+#ifdef CONFIG_FS_DENTRY_CACHE
+	de = fs_dcache_find(filename, true);
+	if (de) {
+		de->size_valid = true;
+		de->size_ret = ret;
+		de->size = ret ? 0 : *size;
+		/* A regular file with a size certainly exists */
+		if (!ret)
+			de->exists = 1;
+	}
+#endif
 	fs_close();
 
 	return ret;
@@ -422,6 +539,7 @@ int fs_write(const char *filename, ulong addr, loff_t offset, loff_t len,
 	void *buf;
 	int ret;
 
+	fs_dcache_invalidate();
 	buf = map_sysmem(addr, len);
 	ret = info->write(filename, buf, offset, len, actwrite);
 	unmap_sysmem(buf);
@@ -95,6 +95,13 @@ int ubifs_leb_read(const struct ubifs_info *c, int lnum, void *buf, int offs,
 {
 	int err;
 
+#ifdef __UBOOT__
+	if (c->leb_buf && lnum == c->leb_buf_lnum && offs >= c->leb_buf_offs) {
+		memcpy(buf, c->leb_buf + offs, len);
+		return 0;
+	}
+#endif
+
 	err = ubi_read(c->ubi, lnum, buf, offs, len);
 	/*
 	 * In case of %-EBADMSG print the error message only if the
@@ -108,6 +115,43 @@ int ubifs_leb_read(const struct ubifs_info *c, int lnum, void *buf, int offs,
 	return err;
 }
 
+#ifdef __UBOOT__
+/**
+ * ubifs_leb_cache_fill - read the rest of a LEB into the LEB cache.
+ * @c: UBIFS file-system description object
+ * @lnum: logical eraseblock number
+ * @offs: offset to start reading from
+ *
+ * Data nodes of a file are written one after another, so when a file is
+ * loaded the next reads very likely hit the same LEB. This function reads
+ * LEB @lnum from @offs to its end with one UBI request, 'ubifs_leb_read()'
+ * then serves reads from this range out of @c->leb_buf. Nothing is done if
+ * the range is already cached or if there is no cache. Returns zero in case
+ * of success and a negative error code in case of failure, in which case the
+ * cache is left empty and reads go to the flash.
+ */
+int ubifs_leb_cache_fill(struct ubifs_info *c, int lnum, int offs)
+{
+	int err;
+
+	if (!c->leb_buf)
+		return 0;
+	if (lnum == c->leb_buf_lnum && offs >= c->leb_buf_offs)
+		return 0;
+
+	c->leb_buf_lnum = -1;
+	err = ubi_read(c->ubi, lnum, c->leb_buf + offs, offs,
+		       c->leb_size - offs);
+	if (err)
+		return err;
+
+	c->leb_buf_lnum = lnum;
+	c->leb_buf_offs = offs;
+
+	return 0;
+}
+#endif
+
 int ubifs_leb_write(struct ubifs_info *c, int lnum, const void *buf, int offs,
 		    int len)
 {
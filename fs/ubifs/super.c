@@ -2223,6 +2223,11 @@ static struct ubifs_info *alloc_ubifs_info(struct ubi_volume_desc *ubi)
 		INIT_LIST_HEAD(&c->orph_list);
 		INIT_LIST_HEAD(&c->orph_new);
 		c->no_chk_data_crc = 1;
+#ifdef __UBOOT__
+		/* File loads go through bulk-reads, see ubifs_read() */
+		c->bulk_read = 1;
+		c->leb_buf_lnum = -1;
+#endif
 
 		c->highest_inum = UBIFS_FIRST_INO;
 		c->lhead_lnum = c->ltail_lnum = UBIFS_LOG_LNUM;
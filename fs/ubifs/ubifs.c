@@ -681,23 +681,13 @@ static inline void *kmap(struct page *page)
 	return page->addr;
 }
 
-static int read_block(struct inode *inode, void *addr, unsigned int block,
-		      struct ubifs_data_node *dn)
+static int decompress_block(struct ubifs_info *c, struct inode *inode,
+			    void *addr, unsigned int block,
+			    struct ubifs_data_node *dn)
 {
-	struct ubifs_info *c = inode->i_sb->s_fs_info;
 	int err, len, out_len;
-	union ubifs_key key;
 	unsigned int dlen;
 
-	data_key_init(c, &key, inode->i_ino, block);
-	err = ubifs_tnc_lookup(c, &key, dn);
-	if (err) {
-		if (err == -ENOENT)
-			/* Not found, so it must be a hole */
-			memset(addr, 0, UBIFS_BLOCK_SIZE);
-		return err;
-	}
-
 	ubifs_assert(le64_to_cpu(dn->ch.sqnum) > ubifs_inode(inode)->creat_sqnum);
 
 	len = le32_to_cpu(dn->size);
@@ -728,6 +718,95 @@ dump:
 	return -EINVAL;
 }
 
+static int read_block(struct inode *inode, void *addr, unsigned int block,
+		      struct ubifs_data_node *dn)
+{
+	struct ubifs_info *c = inode->i_sb->s_fs_info;
+	union ubifs_key key;
+	int err;
+
+	data_key_init(c, &key, inode->i_ino, block);
+	err = ubifs_tnc_lookup(c, &key, dn);
+	if (err) {
+		if (err == -ENOENT)
+			/* Not found, so it must be a hole */
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+		return err;
+	}
+
+	return decompress_block(c, inode, addr, block, dn);
+}
+
+/*
+ * Read @count whole blocks of @inode starting at @block into @addr.
+ *
+ * Data nodes that follow each other in one LEB are looked up with a single
+ * TNC walk and read with a single flash request ('ubifs_tnc_get_bu_keys()'
+ * and 'ubifs_tnc_bulk_read()'), then decompressed straight into @addr. The
+ * LEB the nodes come from is read into the LEB cache up to its end, so the
+ * next runs of the file usually need no flash access at all.
+ *
+ * Returns the number of blocks read, which is less than @count if some
+ * block could not be read this way: the caller reads the rest one block at
+ * a time, which also reports the error.
+ */
+static unsigned int read_blocks_bulk(struct ubifs_info *c,
+				     struct inode *inode, void *addr,
+				     unsigned int block, unsigned int count)
+{
+	struct bu_info *bu = &c->bu;
+	unsigned int first = block, end = block + count, n;
+	void *buf;
+	int i;
+
+	while (block < end) {
+		data_key_init(c, &bu->key, inode->i_ino, block);
+		bu->buf_len = c->max_bu_buf_len;
+		if (ubifs_tnc_get_bu_keys(c, bu))
+			break;
+
+		if (!bu->cnt) {
+			/* Only a hole up to the end of file or the next node */
+			n = bu->eof ? end - block : min_t(unsigned int,
+							  bu->blk_cnt,
+							  end - block);
+			if (!n)
+				break;
+			memset(addr, 0, n * UBIFS_BLOCK_SIZE);
+			addr += n * UBIFS_BLOCK_SIZE;
+			block += n;
+			continue;
+		}
+
+		ubifs_leb_cache_fill(c, bu->zbranch[0].lnum,
+				     bu->zbranch[0].offs);
+		if (ubifs_tnc_bulk_read(c, bu))
+			break;
+
+		buf = bu->buf;
+		for (i = 0; i < bu->cnt; i++) {
+			n = key_block(c, &bu->zbranch[i].key);
+			if (n >= end)
+				break;
+			if (n > block) {
+				/* Hole between two data nodes */
+				memset(addr, 0, (n - block) * UBIFS_BLOCK_SIZE);
+				addr += (n - block) * UBIFS_BLOCK_SIZE;
+				block = n;
+			}
+			if (decompress_block(c, inode, addr, block, buf))
+				return block - first;
+			addr += UBIFS_BLOCK_SIZE;
+			block++;
+			buf += ALIGN(bu->zbranch[i].len, 8);
+		}
+		if (i < bu->cnt)
+			break;
+	}
+
+	return block - first;
+}
+
 static int do_readpage(struct ubifs_info *c, struct inode *inode,
 		       struct page *page, int last_block_size)
 {
@@ -850,6 +929,7 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 	int i;
 	int count;
 	int last_block_size = 0;
+	unsigned int done = 0;
 
 	*actread = 0;
 
@@ -894,10 +974,23 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 
 	count = (size + UBIFS_BLOCK_SIZE - 1) >> UBIFS_BLOCK_SHIFT;
 
-	page.addr = buf;
-	page.index = offset / PAGE_SIZE;
+	/*
+	 * Whole blocks go through bulk-reads, a partial last block and
+	 * whatever the bulk-read could not handle are read page by page.
+	 */
+	if (c->bulk_read && c->bu.buf) {
+		c->leb_buf = vmalloc(c->leb_size);
+		c->leb_buf_lnum = -1;
+		done = read_blocks_bulk(c, inode, buf,
+					offset >> UBIFS_BLOCK_SHIFT,
+					size >> UBIFS_BLOCK_SHIFT);
+		done >>= UBIFS_BLOCKS_PER_PAGE_SHIFT;
+	}
+
+	page.addr = buf + done * PAGE_SIZE;
+	page.index = offset / PAGE_SIZE + done;
 	page.inode = inode;
-	for (i = 0; i < count; i++) {
+	for (i = done; i < count; i++) {
 		/*
 		 * Make sure to not read beyond the requested size
 		 */
@@ -919,6 +1012,9 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 		*actread = size;
 	}
 
+	vfree(c->leb_buf);
+	c->leb_buf = NULL;
+
 put_inode:
 	ubifs_iput(inode);
 
@@ -1651,6 +1651,9 @@ struct ubifs_debug_info;
  * @max_bu_buf_len: maximum bulk-read buffer length
  * @bu_mutex: protects the pre-allocated bulk-read buffer and @c->bu
  * @bu: pre-allocated bulk-read information
+ * @leb_buf: LEB read cache, only set while U-Boot loads a file
+ * @leb_buf_lnum: LEB held in @leb_buf, %-1 if none
+ * @leb_buf_offs: @leb_buf holds LEB @leb_buf_lnum from this offset to its end
  *
  * @write_reserve_mutex: protects @write_reserve_buf
  * @write_reserve_buf: on the write path we allocate memory, which might
@@ -1893,6 +1896,11 @@ struct ubifs_info {
 	int max_bu_buf_len;
 	struct mutex bu_mutex;
 	struct bu_info bu;
+#ifdef __UBOOT__
+	void *leb_buf;
+	int leb_buf_lnum;
+	int leb_buf_offs;
+#endif
 
 	struct mutex write_reserve_mutex;
 	void *write_reserve_buf;
@@ -2081,6 +2089,9 @@ extern struct ubifs_compressor *ubifs_compressors[UBIFS_COMPR_TYPES_CNT];
 void ubifs_ro_mode(struct ubifs_info *c, int err);
 int ubifs_leb_read(const struct ubifs_info *c, int lnum, void *buf, int offs,
 		   int len, int even_ebadmsg);
+#ifdef __UBOOT__
+int ubifs_leb_cache_fill(struct ubifs_info *c, int lnum, int offs);
+#endif
 int ubifs_leb_write(struct ubifs_info *c, int lnum, const void *buf, int offs,
 		    int len);
 int ubifs_leb_change(struct ubifs_info *c, int lnum, const void *buf, int len);
@@ -206,6 +206,70 @@ static inline void blkcache_invalidate(int iftype, int dev) {}
 
 #endif
 
+#if defined(CONFIG_BLOCK_READAHEAD) && CONFIG_IS_ENABLED(BLK)
+/**
+ * blkra_read() - attempt to read a set of blocks through the read-ahead
+ * window
+ *
+ * @desc:	Block device descriptor
+ * @start:	Start block number to read
+ * @blkcnt:	Number of blocks to read
+ * @buffer:	Destination buffer for data read
+ * @return @blkcnt if the read was served, 0 if the caller must read from
+ * the device itself
+ */
+ulong blkra_read(struct blk_desc *desc, lbaint_t start, lbaint_t blkcnt,
+		 void *buffer);
+
+/**
+ * blkra_invalidate() - discard the read-ahead window and hints of a device
+ * because of a write, erase or hardware partition switch
+ *
+ * @desc:	Block device descriptor
+ */
+void blkra_invalidate(struct blk_desc *desc);
+
+/**
+ * blkra_release() - free the read-ahead window of a device which goes away
+ *
+ * A new device may later be allocated at the same address, it must not
+ * find the window of this one.
+ *
+ * @desc:	Block device descriptor
+ */
+void blkra_release(struct blk_desc *desc);
+
+/**
+ * blk_prefetch() - announce blocks which are about to be read
+ *
+ * Filesystems call this with the extents of a file before reading it, so
+ * that the read-ahead window never crosses into unrelated data and the
+ * very first read of an extent can already be enlarged.
+ *
+ * @desc:	Block device descriptor
+ * @start:	Start block number (absolute, not partition-relative)
+ * @blkcnt:	Number of blocks
+ * @return 0 if OK, -ve on error
+ */
+int blk_prefetch(struct blk_desc *desc, lbaint_t start, lbaint_t blkcnt);
+#else
+static inline ulong blkra_read(struct blk_desc *desc, lbaint_t start,
+			       lbaint_t blkcnt, void *buffer)
+{
+	return 0;
+}
+
+static inline void blkra_invalidate(struct blk_desc *desc) {}
+
+static inline void blkra_release(struct blk_desc *desc) {}
+
+static inline int blk_prefetch(struct blk_desc *desc, lbaint_t start,
+			       lbaint_t blkcnt)
+{
+	return 0;
+}
+#endif
+
 #if CONFIG_IS_ENABLED(BLK)
 struct udevice;
 
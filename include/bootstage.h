@@ -205,6 +205,11 @@ enum bootstage_id {
 	BOOTSTATE_ID_ACCUM_DM_SPL,
 	BOOTSTATE_ID_ACCUM_DM_F,
 	BOOTSTATE_ID_ACCUM_DM_R,
+	BOOTSTAGE_ID_DISPLAY_LOGO,
+	BOOTSTAGE_ID_START_TPL,
+	BOOTSTAGE_ID_END_TPL,
+	BOOTSTATE_ID_ACCUM_DM_TPL,
+	BOOTSTAGE_ID_ACCUM_DRAM,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
@@ -212,6 +217,56 @@ enum bootstage_id {
 	BOOTSTAGE_ID_ALLOC,
 };
 
+/* Categories of profile spans, see bootstage_span() */
+enum bootstage_span_cat {
+	BOOTSTAGE_SPAN_PROBE,		/* Driver probe, named by device */
+	BOOTSTAGE_SPAN_BLK_READ,	/* Block device reads */
+	BOOTSTAGE_SPAN_BLK_WRITE,	/* Block device writes */
+	BOOTSTAGE_SPAN_DECOMP,		/* Decompression, bytes produced */
+	BOOTSTAGE_SPAN_HASH,		/* Hash or checksum, bytes hashed */
+
+	BOOTSTAGE_SPAN_CAT_COUNT,
+};
+
+/*
+ * Layout of the data written by bootstage_stash(). Only fixed-size fields
+ * are used so that host tools (tools/proftool) can read it:
+ *
+ *	struct bootstage_hdr
+ *	struct bootstage_stash_record, hdr.count times
+ *	struct bootstage_stash_span, hdr.span_count times
+ *	record names, then span names, each nul-terminated
+ */
+enum {
+	BOOTSTAGE_VERSION	= 1,
+	BOOTSTAGE_MAGIC		= 0xb00757a3,
+};
+
+struct bootstage_hdr {
+	uint32_t version;	/* BOOTSTAGE_VERSION */
+	uint32_t count;		/* Number of records */
+	uint32_t size;		/* Total data size (non-zero if valid) */
+	uint32_t magic;		/* BOOTSTAGE_MAGIC */
+	uint32_t span_count;	/* Number of profile spans */
+	uint32_t span_dropped;	/* Spans which did not fit when recording */
+};
+
+struct bootstage_stash_record {
+	uint32_t time_us;	/* Mark, or accumulated time */
+	uint32_t start_us;	/* Non-zero for an accumulated record */
+	uint32_t flags;		/* enum bootstage_flags */
+	uint32_t id;		/* enum bootstage_id */
+};
+
+struct bootstage_stash_span {
+	uint32_t start_us;	/* Start of the first operation */
+	uint32_t end_us;	/* End of the last operation */
+	uint32_t busy_us;	/* Time spent in the operations */
+	uint32_t bytes;		/* Bytes transferred or produced */
+	uint16_t count;		/* Number of operations in this span */
+	uint16_t cat;		/* enum bootstage_span_cat */
+};
+
 /*
  * Return the time since boot in microseconds, This is needed for bootstage
  * and should be defined in CPU- or board-specific code. If undefined then
@@ -321,6 +376,29 @@ void bootstage_report(void);
  */
 int bootstage_fdt_add_report(void);
 
+#ifdef CONFIG_BOOTSTAGE_PROFILE
+/**
+ * bootstage_span() - Record a profiled operation which has just finished
+ *
+ * Block device operations continuing the last span recorded (same
+ * category and device) are merged into it, so that the reads which load
+ * an image show up as one span with the total byte count.
+ *
+ * @cat:	Category of the operation
+ * @name:	Device or algorithm name. It is copied, truncated to 31
+ *		characters
+ * @start_us:	Start of the operation, from bootstage_span_start()
+ * @bytes:	Bytes transferred or produced, 0 if not relevant
+ */
+void bootstage_span(enum bootstage_span_cat cat, const char *name,
+		    ulong start_us, ulong bytes);
+
+static inline ulong bootstage_span_start(void)
+{
+	return timer_get_boot_us();
+}
+#endif
+
 /**
  * Stash bootstage data into memory
  *
@@ -330,6 +408,29 @@ int bootstage_fdt_add_report(void);
  */
 int bootstage_stash(void *base, int size);
 
+/**
+ * bootstage_stash_default() - Stash bootstage data for the next boot phase
+ *
+ * Writes to CONFIG_BOOTSTAGE_STASH_ADDR, from where the next phase picks
+ * it up with bootstage_unstash_default().
+ *
+ * @return 0 if stashed ok, -ve on error
+ */
+int bootstage_stash_default(void);
+
+/**
+ * bootstage_unstash_default() - Continue the records of an earlier phase
+ *
+ * Reads the stash at CONFIG_BOOTSTAGE_STASH_ADDR and invalidates it, so
+ * that a later boot does not pick up stale records left in memory.
+ * The record names still point into the stash: call bootstage_relocate()
+ * before overwriting it.
+ *
+ * @return 0 if unstashed ok, -ENOENT if there is no stash, other -ve on
+ *	error
+ */
+int bootstage_unstash_default(void);
+
 /**
  * Read bootstage data from memory
  *
@@ -420,6 +521,16 @@ static inline int bootstage_unstash(const void *base, int size)
 	return 0;	/* Pretend to succeed */
 }
 
+static inline int bootstage_stash_default(void)
+{
+	return 0;	/* Pretend to succeed */
+}
+
+static inline int bootstage_unstash_default(void)
+{
+	return -ENOENT;
+}
+
 static inline int bootstage_get_size(void)
 {
 	return 0;
@@ -432,6 +543,19 @@ static inline int bootstage_init(bool first)
 
 #endif /* ENABLE_BOOTSTAGE */
 
+#if !defined(ENABLE_BOOTSTAGE) || !defined(CONFIG_BOOTSTAGE_PROFILE)
+static inline void bootstage_span(enum bootstage_span_cat cat,
+				  const char *name, ulong start_us,
+				  ulong bytes)
+{
+}
+
+static inline ulong bootstage_span_start(void)
+{
+	return 0;
+}
+#endif
+
 /* Helper macro for adding a bootstage to a line of code */
 #define BOOTSTAGE_MARKER()	\
 		bootstage_mark_code(__FILE__, __func__, __LINE__)
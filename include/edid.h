@@ -846,6 +846,8 @@ int drm_add_edid_modes(struct hdmi_edid_data *data, u8 *edid);
 bool drm_detect_hdmi_monitor(struct edid *edid);
 bool drm_detect_monitor_audio(struct edid *edid);
 int do_cea_modes(struct hdmi_edid_data *data, const u8 *db, u8 len);
+int drm_do_get_edid_base(struct ddc_adapter *adap, u8 *edid);
+int drm_do_get_edid_ext(struct ddc_adapter *adap, u8 *edid);
 int drm_do_get_edid(struct ddc_adapter *adap, u8 *edid);
 enum hdmi_quantization_range
 drm_default_rgb_quant_range(struct drm_display_mode *mode);
@@ -25,7 +25,15 @@
 #define DIRENTSPERCLUST	((mydata->clust_size * mydata->sect_size) / \
 			 sizeof(dir_entry))
 
+/* FAT sectors cached by get_fatent(), a multiple of 3 to suit FAT12 */
+#ifdef CONFIG_FS_FAT_BUF_BLOCKS
+#define FATBUFBLOCKS	CONFIG_FS_FAT_BUF_BLOCKS
+#else
 #define FATBUFBLOCKS	6
+#endif
+#if FATBUFBLOCKS % 3
+#error "CONFIG_FS_FAT_BUF_BLOCKS must be a multiple of 3"
+#endif
 #define FATBUFSIZE	(mydata->sect_size * FATBUFBLOCKS)
 #define FAT12BUFSIZE	((FATBUFSIZE*2)/3)
 #define FAT16BUFSIZE	(FATBUFSIZE/2)
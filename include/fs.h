@@ -84,6 +84,19 @@ int fs_size(const char *filename, loff_t *size);
 int fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	    loff_t *actread);
 
+/**
+ * fs_dcache_invalidate() - Drop all cached fs_exists()/fs_size() results
+ *
+ * The filesystem write paths call this (including those not going through
+ * fs_write(), e.g. saveenv), as does part_init() when a medium is
+ * (re)scanned.
+ */
+#ifdef CONFIG_FS_DENTRY_CACHE
+void fs_dcache_invalidate(void);
+#else
+static inline void fs_dcache_invalidate(void) {}
+#endif
+
 /*
  * fs_write - Write file to the partition previously set by fs_set_blk_dev()
  * Note that not all filesystem types support offset!=0.
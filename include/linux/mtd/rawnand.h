@@ -276,6 +276,9 @@ typedef enum {
 /* ONFI subfeature parameters length */
 #define ONFI_SUBFEATURE_PARAM_LEN	4
 
+/* ONFI optional commands Page Cache Program supported? */
+#define ONFI_OPT_CMD_PROG_CACHE		(1 << 0)
+
 /* ONFI optional commands SET/GET FEATURES supported? */
 #define ONFI_OPT_CMD_SET_GET_FEATURES	(1 << 2)
 
@@ -879,7 +882,7 @@ struct nand_chip {
 	int (*scan_bbt)(struct mtd_info *mtd);
 	int (*write_page)(struct mtd_info *mtd, struct nand_chip *chip,
 			uint32_t offset, int data_len, const uint8_t *buf,
-			int oob_required, int page, int raw);
+			int oob_required, int page, int cached, int raw);
 	int (*onfi_set_features)(struct mtd_info *mtd, struct nand_chip *chip,
 			int feature_addr, uint8_t *subfeature_para);
 	int (*onfi_get_features)(struct mtd_info *mtd, struct nand_chip *chip,
@@ -1264,6 +1267,7 @@ int nand_prog_page_begin_op(struct nand_chip *chip, unsigned int page,
 			    unsigned int offset_in_page, const void *buf,
 			    unsigned int len);
 int nand_prog_page_end_op(struct nand_chip *chip);
+int nand_prog_page_cache_end_op(struct nand_chip *chip);
 int nand_prog_page_op(struct nand_chip *chip, unsigned int page,
 		      unsigned int offset_in_page, const void *buf,
 		      unsigned int len);
@@ -69,6 +69,18 @@
 		   SPI_MEM_OP_NO_DUMMY,					\
 		   SPI_MEM_OP_NO_DATA)
 
+#define SPINAND_PAGE_READ_CACHE_SEQ_OP					\
+	SPI_MEM_OP(SPI_MEM_OP_CMD(0x31, 1),				\
+		   SPI_MEM_OP_NO_ADDR,					\
+		   SPI_MEM_OP_NO_DUMMY,					\
+		   SPI_MEM_OP_NO_DATA)
+
+#define SPINAND_PAGE_READ_CACHE_END_OP					\
+	SPI_MEM_OP(SPI_MEM_OP_CMD(0x3f, 1),				\
+		   SPI_MEM_OP_NO_ADDR,					\
+		   SPI_MEM_OP_NO_DUMMY,					\
+		   SPI_MEM_OP_NO_DATA)
+
 #define SPINAND_PAGE_READ_FROM_CACHE_OP(fast, addr, ndummy, buf, len)	\
 	SPI_MEM_OP(SPI_MEM_OP_CMD(fast ? 0x0b : 0x03, 1),		\
 		   SPI_MEM_OP_ADDR(2, addr, 1),				\
@@ -245,6 +257,8 @@ struct spinand_ecc_info {
 };
 
 #define SPINAND_HAS_QE_BIT		BIT(0)
+/* Supports READ CACHE SEQUENTIAL (0x31) and READ CACHE END (0x3f) */
+#define SPINAND_HAS_READ_CACHE_SEQ	BIT(1)
 
 /**
  * struct spinand_info - Structure used to describe SPI NAND chips
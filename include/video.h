@@ -67,6 +67,14 @@ enum video_log2_bpp {
  * @flush_dcache:	true to enable flushing of the data cache after
  *		the LCD is updated
  * @cmap:	Colour map for 8-bit-per-pixel displays
+ * @pan_size:	Size of the frame buffer area the display can be panned
+ *		over to scroll, 0 if the driver cannot move its start
+ *		address (see video_ops.set_fb_base())
+ * @pan_base:	Start of the pan area, @fb moves within it when scrolling
+ * @damage_ystart:	First line changed since the last video_sync()
+ * @damage_yend:	Line after the last one changed since the last
+ *		video_sync(), nothing changed if <= @damage_ystart
+ * @fb_fixed:	true once @fb is used outside the uclass, it must not move
  */
 struct video_priv {
 	/* Things set up by the driver: */
@@ -76,6 +84,7 @@ struct video_priv {
 	enum video_log2_bpp bpix;
 	const char *vidconsole_drv_name;
 	int font_size;
+	int pan_size;
 
 	/*
 	 * Things that are private to the uclass: don't use these in the
@@ -88,10 +97,27 @@ struct video_priv {
 	int colour_bg;
 	bool flush_dcache;
 	ushort *cmap;
+	void *pan_base;
+	int damage_ystart;
+	int damage_yend;
+	bool fb_fixed;
 };
 
-/* Placeholder - there are no video operations at present */
+/**
+ * struct video_ops - Video device operations
+ */
 struct video_ops {
+	/**
+	 * set_fb_base() - Make the display scan out from a new address
+	 *
+	 * Used to scroll by panning when @pan_size is set. The frame buffer
+	 * at @fb has the same layout as the one set up at probe time.
+	 *
+	 * @dev:	Video device
+	 * @fb:		New start of the visible frame buffer
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*set_fb_base)(struct udevice *dev, void *fb);
 };
 
 #define video_get_ops(dev)        ((struct video_ops *)(dev)->driver->ops)
@@ -125,6 +151,43 @@ int video_reserve(ulong *addrp);
  */
 void video_sync(struct udevice *vid);
 
+/**
+ * video_damage() - Record that part of a frame buffer was changed
+ *
+ * video_sync() only flushes the lines recorded here since the last sync,
+ * or the whole frame buffer if none were. Anything drawing into @fb through
+ * the video uclass helpers does this already.
+ *
+ * @dev:	Video device
+ * @y:		First line changed
+ * @height:	Number of lines changed
+ */
+void video_damage(struct udevice *vid, int y, int height);
+
+/**
+ * video_scroll() - Scroll the display up by moving its start address
+ *
+ * The lines exposed at the bottom are cleared to the background colour.
+ * Once the end of the pan area is reached, the visible frame is copied back
+ * to its start, so the full frame buffer is moved only once per pan area
+ * rather than once per scroll.
+ *
+ * @dev:	Video device
+ * @lines:	Number of lines to scroll by
+ * @return 0 if OK, -ENOSYS if the device cannot pan, other -ve on error
+ */
+int video_scroll(struct udevice *vid, int lines);
+
+/**
+ * video_fix_fb() - Keep the frame buffer at its current address
+ *
+ * Called when the address of @fb is handed out, e.g. to an EFI application.
+ * The console then scrolls by moving the text instead of panning.
+ *
+ * @dev:	Video device
+ */
+void video_fix_fb(struct udevice *vid);
+
 /**
  * video_sync_all() - Sync all devices' frame buffers with there hardware
  *
@@ -18,9 +18,16 @@
 #endif
 
 #define MEMORY_POOL_SIZE	32 * 1024 * 1024
-#define DRM_ROCKCHIP_FB_SIZE \
+#define DRM_ROCKCHIP_FB_FRAME_SIZE \
 	VNBYTES(DRM_ROCKCHIP_FB_BPP) * DRM_ROCKCHIP_FB_WIDTH * DRM_ROCKCHIP_FB_HEIGHT
+#ifdef CONFIG_DRM_ROCKCHIP_CONSOLE_PAN
+/* Two frames, the console scrolls by panning the display over them */
+#define DRM_ROCKCHIP_FB_SIZE	(DRM_ROCKCHIP_FB_FRAME_SIZE * 2)
+#else
+#define DRM_ROCKCHIP_FB_SIZE	DRM_ROCKCHIP_FB_FRAME_SIZE
+#endif
 
+int rockchip_preload_bmp(const char *bmp);
 int rockchip_show_bmp(const char *bmp);
 int rockchip_show_logo(void);
 void rockchip_display_fixup(void *blob);
@@ -5,6 +5,7 @@
 */
 
 #include <common.h>
+#include <div64.h>
 #include <fastboot.h>
 #include <fb_mmc.h>
 #include <net.h>
@@ -29,18 +30,26 @@ struct __attribute__((packed)) fastboot_header {
 	unsigned short seq;
 };
 
-#define PACKET_SIZE 1024
+#define PACKET_SIZE CONFIG_UDP_FUNCTION_FASTBOOT_PACKET_SIZE
 #define FASTBOOT_HEADER_SIZE sizeof(struct fastboot_header)
-#define DATA_SIZE (PACKET_SIZE - FASTBOOT_HEADER_SIZE)
+#define FASTBOOT_COMMAND_LEN 64
 #define FASTBOOT_VERSION "0.4"
+/* Largest UDP payload that fits a 1500-byte MTU */
+#define FASTBOOT_MTU_PACKET_SIZE 1472
+/* Download progress mark every 128 KiB, as over USB */
+#define BYTES_PER_DOT 0x20000
+
+#if PACKET_SIZE > FASTBOOT_MTU_PACKET_SIZE && !defined(CONFIG_IP_DEFRAG)
+#error "fastboot UDP packets above 1472 bytes need CONFIG_IP_DEFRAG"
+#endif
 
 /* Sequence number sent for every packet */
 static unsigned short fb_sequence_number = 1;
 static const unsigned short fb_packet_size = PACKET_SIZE;
 static const unsigned short fb_udp_version = 1;
 
-/* Keep track of last packet for resubmission */
-static uchar last_packet[PACKET_SIZE];
+/* Keep track of last packet for resubmission, we only send short ones */
+static uchar last_packet[FASTBOOT_HEADER_SIZE + FASTBOOT_RESPONSE_LEN];
 static unsigned int last_packet_len = 0;
 
 /* Parsed from first fastboot command packet */
@@ -51,6 +60,7 @@ static char *cmd_parameter = NULL;
 static unsigned int bytes_received = 0;
 static unsigned int bytes_expected = 0;
 static unsigned int image_size = 0;
+static ulong download_start;
 
 static struct in_addr fastboot_remote_ip;
 /* The UDP port at their end */
@@ -185,7 +195,7 @@ static void fastboot_send(struct fastboot_header fb_header, char *fastboot_data,
 			/* A/B not implemented, for now do nothing */
 			write_fb_response("OKAY", "", response);
 		} else {
-			error("command %s not implemented.\n", cmd_string);
+			pr_err("command %s not implemented.\n", cmd_string);
 			write_fb_response("FAIL", "unrecognized command", response);
 		}
 		/* Sent some INFO packets, need to update sequence number in header */
@@ -198,7 +208,7 @@ static void fastboot_send(struct fastboot_header fb_header, char *fastboot_data,
 		packet += strlen(response);
 		break;
 	default:
-		error("ID %d not implemented.\n", fb_header.id);
+		pr_err("ID %d not implemented.\n", fb_header.id);
 		return;
 	}
 
@@ -216,7 +226,7 @@ static void fastboot_send(struct fastboot_header fb_header, char *fastboot_data,
 		if (!strcmp("boot", cmd_string)) {
 			boot_downloaded_image();
 		} else if (!strcmp("continue", cmd_string)) {
-			run_command(getenv("bootcmd"), CMD_FLAG_ENV);
+			run_command(env_get("bootcmd"), CMD_FLAG_ENV);
 		} else if (!strncmp("reboot", cmd_string, 6)) {
 			/* Matches reboot or reboot-bootloader */
 			do_reset(NULL, 0, 0, NULL);
@@ -251,7 +261,7 @@ static void fb_getvar(char *response)
 		sprintf(buf_size_str, "0x%08x", CONFIG_FASTBOOT_BUF_SIZE);
 		write_fb_response("OKAY", buf_size_str, response);
 	} else if (!strcmp("serialno", cmd_parameter)) {
-		const char *tmp = getenv("serial#");
+		const char *tmp = env_get("serial#");
 		if (tmp) {
 			write_fb_response("OKAY", tmp, response);
 		} else {
@@ -260,7 +270,7 @@ static void fb_getvar(char *response)
 	} else if (!strcmp("version-baseband", cmd_parameter)) {
 		write_fb_response("OKAY", "N/A", response);
 	} else if (!strcmp("product", cmd_parameter)) {
-		const char *board = getenv("board");
+		const char *board = env_get("board");
 		if (board) {
 			write_fb_response("OKAY", board, response);
 		} else {
@@ -291,7 +301,7 @@ static void fb_getvar(char *response)
 		dev_desc = blk_get_dev("mmc", 0);
 		if (!dev_desc) {
 			write_fb_response("FAIL", "block device not found", response);
-		} else if (part_get_info_efi_by_name(dev_desc, part_name, &part_info) < 0) {
+		} else if (part_get_info_by_name(dev_desc, part_name, &part_info) < 0) {
 			write_fb_response("FAIL", "partition not found", response);
 		} else if (!strncmp("partition-type", cmd_parameter, 14)) {
 			write_fb_response("OKAY", (char*)part_info.type, response);
@@ -338,11 +348,19 @@ static void fb_download(char *fastboot_data, unsigned int fastboot_data_len,
 		if (bytes_expected > CONFIG_FASTBOOT_BUF_SIZE) {
 			write_fb_response("FAIL", cmd_parameter, response);
 		} else {
+			printf("Starting download of %u bytes\n",
+			       bytes_expected);
+			download_start = get_timer(0);
 			write_fb_response("DATA", cmd_parameter, response);
 		}
 	} else if (fastboot_data_len == 0 && (bytes_received >= bytes_expected)) {
+		ulong elapsed = max(get_timer(download_start), 1UL);
+
 		/* Download complete. Respond with "OKAY" */
 		write_fb_response("OKAY", "", response);
+		printf("\ndownloading of %u bytes finished in %lu ms (%lu KiB/s)\n",
+		       bytes_received, elapsed,
+		       (ulong)lldiv((u64)bytes_received * 1000 / 1024, elapsed));
 		image_size = bytes_received;
 		bytes_expected = bytes_received = 0;
 	} else {
@@ -354,6 +372,13 @@ static void fb_download(char *fastboot_data, unsigned int fastboot_data_len,
 		/* Download data to CONFIG_FASTBOOT_BUF_ADDR */
 		memcpy((void*)CONFIG_FASTBOOT_BUF_ADDR + bytes_received, fastboot_data,
 				fastboot_data_len);
+		if ((bytes_received + fastboot_data_len) / BYTES_PER_DOT !=
+		    bytes_received / BYTES_PER_DOT) {
+			putc('.');
+			if (!((bytes_received + fastboot_data_len) /
+			      BYTES_PER_DOT % 74))
+				putc('\n');
+		}
 		bytes_received += fastboot_data_len;
 	}
 }
@@ -390,7 +415,7 @@ static void fb_erase(char *response)
 static void fb_continue(char *response)
 {
 	char *bootcmd;
-	bootcmd = getenv("bootcmd");
+	bootcmd = env_get("bootcmd");
 	if (bootcmd) {
 		write_fb_response("OKAY", "", response);
 	} else {
@@ -417,7 +442,7 @@ static void fb_reboot(char *response)
 static void boot_downloaded_image(void)
 {
 	char kernel_addr[12];
-	char *fdt_addr = getenv("fdt_addr_r");
+	char *fdt_addr = env_get("fdt_addr_r");
 	char *bootm_args[] = { "bootm", kernel_addr, "-", fdt_addr, NULL };
 
 	sprintf(kernel_addr, "0x%lx", (long)CONFIG_FASTBOOT_BUF_ADDR);
@@ -474,7 +499,8 @@ static void fastboot_handler(uchar *packet, unsigned dport, struct in_addr sip,
 		unsigned sport, unsigned len)
 {
 	struct fastboot_header fb_header;
-	char fastboot_data[DATA_SIZE] = {0};
+	char fastboot_cmd[FASTBOOT_COMMAND_LEN + 1] = {0};
+	char *fastboot_data = fastboot_cmd;
 	unsigned int fastboot_data_len = 0;
 
 	if (dport != fastboot_our_port) {
@@ -500,8 +526,14 @@ static void fastboot_handler(uchar *packet, unsigned dport, struct in_addr sip,
 	case FASTBOOT_INIT:
 	case FASTBOOT_FASTBOOT:
 		fastboot_data_len = len;
-		if (len > 0) {
-			memcpy(fastboot_data, packet, len);
+		if (cmd_string) {
+			/* Download data is consumed straight from the packet */
+			fastboot_data = (char *)packet;
+		} else if (len > 0) {
+			/* Commands are parsed as strings */
+			fastboot_data_len = min_t(unsigned int, len,
+						  FASTBOOT_COMMAND_LEN);
+			memcpy(fastboot_cmd, packet, fastboot_data_len);
 		}
 		if (fb_header.seq == fb_sequence_number) {
 			fastboot_send(fb_header, fastboot_data, fastboot_data_len, 0);
@@ -512,7 +544,7 @@ static void fastboot_handler(uchar *packet, unsigned dport, struct in_addr sip,
 		}
 		break;
 	default:
-		error("ID %d not implemented.\n", fb_header.id);
+		pr_err("ID %d not implemented.\n", fb_header.id);
 		fb_header.id = FASTBOOT_ERROR;
 		fastboot_send(fb_header, fastboot_data, 0, 0);
 		break;
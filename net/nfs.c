@@ -45,10 +45,33 @@
 #define NFS_RPC_ERR	1
 #define NFS_RPC_DROP	124
 
+#if NFS_READ_SIZE > 1024 && !defined(CONFIG_IP_DEFRAG)
+#error "NFS read sizes above 1024 bytes need CONFIG_IP_DEFRAG"
+#endif
+
+#ifdef CONFIG_NFS_READ_WINDOW
+#define NFS_READ_WINDOW	CONFIG_NFS_READ_WINDOW
+#else
+#define NFS_READ_WINDOW	1
+#endif
+
+/* Print a hash mark every this many bytes loaded */
+#define NFS_HASH_BYTES	(NFS_READ_SIZE / 2 * 10)
+
+/* A READ request in flight, its slot is free when id is 0 */
+struct nfs_read {
+	unsigned long id;
+	int offset;
+	int len;
+};
+
 static int fs_mounted;
 static unsigned long rpc_id;
-static int nfs_offset = -1;
-static int nfs_len;
+static int nfs_offset = -1;	/* offset of the next READ request */
+static int nfs_len;		/* size of READ requests */
+static int nfs_file_end;	/* end of file, -1 until seen */
+static int nfs_loaded;		/* bytes loaded, for progress */
+static struct nfs_read nfs_reads[NFS_READ_WINDOW];
 static ulong nfs_timeout = NFS_TIMEOUT;
 
 static char dirfh[NFS_FHSIZE];	/* NFSv2 / NFSv3 file handle of directory */
@@ -386,6 +409,45 @@ static void nfs_read_req(int offset, int readlen)
 	rpc_req(PROG_NFS, NFS_READ, data, len);
 }
 
+/*
+ * Send READ requests from the free slots until the window is full or the
+ * end of the file is reached. Already pending requests are sent again if
+ * @resend is set, after a timeout.
+ */
+static void nfs_read_send(bool resend)
+{
+	struct nfs_read *r;
+	int i;
+
+	for (i = 0; i < NFS_READ_WINDOW; i++) {
+		r = &nfs_reads[i];
+		if (!r->id) {
+			if (nfs_file_end >= 0 && nfs_offset >= nfs_file_end)
+				continue;
+			r->offset = nfs_offset;
+			r->len = nfs_len;
+			nfs_offset += nfs_len;
+		} else if (!resend) {
+			continue;
+		}
+		nfs_read_req(r->offset, r->len);
+		r->id = rpc_id;
+	}
+}
+
+/* All data up to the end of file has been received */
+static bool nfs_read_done(void)
+{
+	int i;
+
+	for (i = 0; i < NFS_READ_WINDOW; i++) {
+		if (nfs_reads[i].id)
+			return false;
+	}
+
+	return nfs_file_end >= 0;
+}
+
 /**************************************************************************
 RPC request dispatcher
 **************************************************************************/
@@ -416,7 +478,7 @@ static void nfs_send(void)
 		nfs_lookup_req(nfs_filename);
 		break;
 	case STATE_READ_REQ:
-		nfs_read_req(nfs_offset, nfs_len);
+		nfs_read_send(true);
 		break;
 	case STATE_READLINK_REQ:
 		nfs_readlink_req();
@@ -652,19 +714,43 @@ static int nfs_readlink_reply(uchar *pkt, unsigned len)
 	return 0;
 }
 
+static void nfs_show_progress(int rlen)
+{
+	int hashes = nfs_loaded / NFS_HASH_BYTES;
+
+	nfs_loaded += rlen;
+	while (hashes < nfs_loaded / NFS_HASH_BYTES) {
+		if (hashes && !(hashes % HASHES_PER_LINE))
+			puts("\n\t ");
+		putc('#');
+		hashes++;
+	}
+}
+
+/*
+ * Handle a READ reply: match it with its request, store the data and
+ * update the slot. The data is copied straight from the packet to its
+ * place in the load buffer, whatever order the replies come in.
+ */
 static int nfs_read_reply(uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
-	int rlen;
-	uchar *data_ptr;
+	struct nfs_read *r = NULL;
+	unsigned long id;
+	int rlen, data_offset, i;
+	bool eof;
 
 	debug("%s\n", __func__);
 
-	memcpy(&rpc_pkt.u.data[0], pkt, sizeof(rpc_pkt.u.reply));
+	memcpy(&rpc_pkt.u.data[0], pkt,
+	       min_t(unsigned int, len, NFS_READ_REPLY_HDR_LEN));
 
-	if (ntohl(rpc_pkt.u.reply.id) > rpc_id)
-		return -NFS_RPC_ERR;
-	else if (ntohl(rpc_pkt.u.reply.id) < rpc_id)
+	id = ntohl(rpc_pkt.u.reply.id);
+	for (i = 0; i < NFS_READ_WINDOW; i++) {
+		if (id && nfs_reads[i].id == id)
+			r = &nfs_reads[i];
+	}
+	if (!r)
 		return -NFS_RPC_DROP;
 
 	if (rpc_pkt.u.reply.rstatus  ||
@@ -678,31 +764,52 @@ static int nfs_read_reply(uchar *pkt, unsigned len)
 		return -ntohl(rpc_pkt.u.reply.data[0]);
 	}
 
-	if ((nfs_offset != 0) && !((nfs_offset) %
-			(NFS_READ_SIZE / 2 * 10 * HASHES_PER_LINE)))
-		puts("\n\t ");
-	if (!(nfs_offset % ((NFS_READ_SIZE / 2) * 10)))
-		putc('#');
-
 	if (supported_nfs_versions & NFSV2_FLAG) {
 		rlen = ntohl(rpc_pkt.u.reply.data[18]);
-		data_ptr = (uchar *)&(rpc_pkt.u.reply.data[19]);
+		data_offset = 19;
+		/* NFSv2 servers only return short reads at the end of file */
+		eof = rlen < r->len;
 	} else {  /* NFSV3_FLAG */
 		int nfsv3_data_offset =
 			nfs3_get_attributes_offset(rpc_pkt.u.reply.data);
 
 		/* count value */
 		rlen = ntohl(rpc_pkt.u.reply.data[1 + nfsv3_data_offset]);
+		eof = ntohl(rpc_pkt.u.reply.data[2 + nfsv3_data_offset]);
 		/* Skip unused values :
 			EOF:		32 bits value,
 			data_size:	32 bits value,
 		*/
-		data_ptr = (uchar *)
-			&(rpc_pkt.u.reply.data[4 + nfsv3_data_offset]);
+		data_offset = 4 + nfsv3_data_offset;
 	}
 
-	if (store_block(data_ptr, nfs_offset, rlen))
-			return -9999;
+	/* Header of the reply up to the data, then the data itself */
+	data_offset = 6 * 4 + data_offset * 4;
+	if (rlen < 0 || rlen > r->len || data_offset + rlen > (int)len)
+		return -NFS_RPC_DROP;
+
+	if (store_block(pkt + data_offset, r->offset, rlen))
+		return -9999;
+	nfs_show_progress(rlen);
+
+	if (eof || !rlen) {
+		if (nfs_file_end < 0 || r->offset + rlen < nfs_file_end)
+			nfs_file_end = r->offset + rlen;
+		r->id = 0;
+	} else if (rlen < r->len) {
+		/*
+		 * Short read before the end of file: the server caps the
+		 * transfer size. Ask for the rest and use its size from now.
+		 */
+		debug("NFS server read size %d\n", rlen);
+		nfs_len = min(nfs_len, rlen);
+		r->offset += rlen;
+		r->len -= rlen;
+		nfs_read_req(r->offset, r->len);
+		r->id = rpc_id;
+	} else {
+		r->id = 0;
+	}
 
 	return rlen;
 }
@@ -735,6 +842,10 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 	if (dest != nfs_our_port)
 		return;
 
+	/* READ replies are stored straight from the packet, others copied */
+	if (nfs_state != STATE_READ_REQ && len > sizeof(struct rpc_t))
+		return;
+
 	switch (nfs_state) {
 	case STATE_PRCLOOKUP_PROG_MOUNT_REQ:
 		if (rpc_lookup_reply(PROG_MOUNT, pkt, len) == -NFS_RPC_DROP)
@@ -798,6 +909,11 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			nfs_state = STATE_READ_REQ;
 			nfs_offset = 0;
 			nfs_len = NFS_READ_SIZE;
+			if (supported_nfs_versions & NFSV2_FLAG)
+				nfs_len = min(nfs_len, NFS2_MAXDATA);
+			nfs_file_end = -1;
+			nfs_loaded = 0;
+			memset(nfs_reads, 0, sizeof(nfs_reads));
 			nfs_send();
 		}
 		break;
@@ -822,16 +938,17 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 
 	case STATE_READ_REQ:
 		rlen = nfs_read_reply(pkt, len);
+		if (rlen == -NFS_RPC_DROP)
+			break;
 		net_set_timeout_handler(nfs_timeout, nfs_timeout_handler);
-		if (rlen > 0) {
-			nfs_offset += rlen;
-			nfs_send();
+		if (rlen >= 0 && !nfs_read_done()) {
+			nfs_read_send(false);
 		} else if ((rlen == -NFSERR_ISDIR) || (rlen == -NFSERR_INVAL)) {
 			/* symbolic link */
 			nfs_state = STATE_READLINK_REQ;
 			nfs_send();
 		} else {
-			if (!rlen)
+			if (rlen >= 0)
 				nfs_download_state = NETLOOP_SUCCESS;
 			if (rlen < 0)
 				debug("NFS READ error (%d)\n", rlen);
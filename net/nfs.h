@@ -42,7 +42,17 @@
  * However, if CONFIG_IP_DEFRAG is set, a bigger value could be used.  In any
  * case, most NFS servers are optimized for a power of 2.
  */
+#ifdef CONFIG_NFS_READ_SIZE
+#define NFS_READ_SIZE	CONFIG_NFS_READ_SIZE
+#else
 #define NFS_READ_SIZE	1024	/* biggest power of two that fits Ether frame */
+#endif
+
+/* Largest READ an NFSv2 server will answer */
+#define NFS2_MAXDATA	8192
+
+/* Size of a READ reply up to its data, for NFSv2 and NFSv3 */
+#define NFS_READ_REPLY_HDR_LEN	(6 * 4 + 26 * 4)
 
 /* Values for Accept State flag on RPC answers (See: rfc1831) */
 enum rpc_accept_stat {
@@ -73,7 +83,7 @@ struct rpc_t {
 			uint32_t verifier;
 			uint32_t v2;
 			uint32_t astatus;
-			uint32_t data[NFS_READ_SIZE];
+			uint32_t data[1024];
 		} reply;
 	} u;
 } __attribute__((packed));
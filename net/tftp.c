@@ -8,6 +8,7 @@
 
 #include <common.h>
 #include <command.h>
+#include <div64.h>
 #include <efi_loader.h>
 #include <mapmem.h>
 #include <net.h>
@@ -125,15 +126,33 @@ static char tftp_filename[MAX_LEN];
  * almost-MTU block sizes.  At least try... fall back to 512 if need be.
  * (but those using CONFIG_IP_DEFRAG may want to set a larger block in cfg file)
  */
+#define TFTP_MTU_BLOCKSIZE_MAX 1468
 #ifdef CONFIG_TFTP_BLOCKSIZE
 #define TFTP_MTU_BLOCKSIZE CONFIG_TFTP_BLOCKSIZE
 #else
-#define TFTP_MTU_BLOCKSIZE 1468
+#define TFTP_MTU_BLOCKSIZE TFTP_MTU_BLOCKSIZE_MAX
 #endif
 
 static unsigned short tftp_block_size = TFTP_BLOCK_SIZE;
 static unsigned short tftp_block_size_option = TFTP_MTU_BLOCKSIZE;
 
+/*
+ * RFC 7440 windowsize: number of blocks the server sends before waiting
+ * for our ACK. Only the last block of each window is acknowledged.
+ */
+#ifdef CONFIG_TFTP_WINDOWSIZE
+#define TFTP_WINDOWSIZE CONFIG_TFTP_WINDOWSIZE
+#else
+#define TFTP_WINDOWSIZE 1
+#endif
+
+static unsigned short tftp_windowsize = 1;
+static unsigned short tftp_windowsize_option = TFTP_WINDOWSIZE;
+/* block number closing the current window, to be acknowledged */
+static ulong	tftp_next_ack;
+/* last block we re-acknowledged after a gap in the window */
+static ulong	tftp_last_nack;
+
 #ifdef CONFIG_MCAST_TFTP
 #include <malloc.h>
 #define MTFTP_BITMAPSIZE	0x1000
@@ -211,6 +230,7 @@ static void new_transfer(void)
 	tftp_prev_block = 0;
 	tftp_block_wrap = 0;
 	tftp_block_wrap_offset = 0;
+	tftp_last_nack = (ulong)-1;
 #ifdef CONFIG_CMD_TFTPPUT
 	tftp_put_final_block_sent = 0;
 #endif
@@ -318,8 +338,10 @@ static void tftp_complete(void)
 	time_start = get_timer(time_start);
 	if (time_start > 0) {
 		puts("\n\t ");	/* Line up with "Loading: " */
-		print_size(net_boot_file_size /
-			time_start * 1000, "/s");
+		print_size(lldiv((u64)net_boot_file_size * 1000, time_start),
+			   "/s");
+		printf(" (%lu ms, blksize %d, windowsize %d)", time_start,
+		       tftp_block_size, tftp_windowsize);
 	}
 	puts("\ndone\n");
 	net_set_state(NETLOOP_SUCCESS);
@@ -372,6 +394,10 @@ static void tftp_send(void)
 		/* try for more effic. blk size */
 		pkt += sprintf((char *)pkt, "blksize%c%d%c",
 				0, tftp_block_size_option, 0);
+		/* windowed transfers are only implemented for reading */
+		if (tftp_state == STATE_SEND_RRQ && tftp_windowsize_option > 1)
+			pkt += sprintf((char *)pkt, "windowsize%c%d%c",
+					0, tftp_windowsize_option, 0);
 #ifdef CONFIG_MCAST_TFTP
 		/* Check all preconditions before even trying the option */
 		if (!tftp_mcast_disabled) {
@@ -404,6 +430,9 @@ static void tftp_send(void)
 		s[0] = htons(TFTP_ACK);
 		s[1] = htons(tftp_cur_block);
 		pkt = (uchar *)(s + 2);
+		/* The server now sends the next window after this block */
+		tftp_next_ack = (tftp_cur_block + tftp_windowsize) &
+				(TFTP_SEQUENCE_SIZE - 1);
 #ifdef CONFIG_CMD_TFTPPUT
 		if (tftp_put_active) {
 			int toload = tftp_block_size;
@@ -457,6 +486,31 @@ static void icmp_handler(unsigned type, unsigned code, unsigned dest,
 }
 #endif
 
+/*
+ * A block other than the next one arrived during a windowed transfer.
+ * Retransmissions of blocks we already have are dropped. A block beyond
+ * the next one means a loss within the window: acknowledge the last block
+ * received in order, once, so that the server restarts the window from
+ * there (RFC 7440 section 4).
+ */
+static void tftp_window_gap(void)
+{
+	ulong ahead = (tftp_cur_block - tftp_prev_block) &
+		      (TFTP_SEQUENCE_SIZE - 1);
+
+	/* A timeout must keep acknowledging the last block in order */
+	tftp_cur_block = tftp_prev_block;
+
+	if (!ahead || ahead > tftp_windowsize ||
+	    tftp_last_nack == tftp_prev_block)
+		return;
+
+	debug("TFTP: lost block %lu, restarting window\n",
+	      (tftp_prev_block + 1) & (TFTP_SEQUENCE_SIZE - 1));
+	tftp_last_nack = tftp_prev_block;
+	tftp_send();
+}
+
 static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			 unsigned src, unsigned len)
 {
@@ -527,6 +581,7 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		      pkt, pkt + strlen((char *)pkt) + 1);
 		tftp_state = STATE_OACK;
 		tftp_remote_port = src;
+		new_transfer();
 		/*
 		 * Check for 'blksize' option.
 		 * Careful: "i" is signed, "len" is unsigned, thus
@@ -540,6 +595,16 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 				debug("Blocksize ack: %s, %d\n",
 				      (char *)pkt + i + 8, tftp_block_size);
 			}
+			if (strcmp((char *)pkt + i, "windowsize") == 0) {
+				tftp_windowsize = (unsigned short)
+					simple_strtoul((char *)pkt + i + 11,
+						       NULL, 10);
+				if (!tftp_windowsize ||
+				    tftp_windowsize > tftp_windowsize_option)
+					tftp_windowsize = 1;
+				debug("Windowsize ack: %s, %d\n",
+				      (char *)pkt + i + 11, tftp_windowsize);
+			}
 #ifdef CONFIG_TFTP_TSIZE
 			if (strcmp((char *)pkt+i, "tsize") == 0) {
 				tftp_tsize = simple_strtoul((char *)pkt + i + 6,
@@ -570,6 +635,14 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		len -= 2;
 		tftp_cur_block = ntohs(*(__be16 *)pkt);
 
+		if ((tftp_state == STATE_DATA || tftp_state == STATE_OACK) &&
+		    tftp_windowsize > 1 &&
+		    tftp_cur_block != ((tftp_prev_block + 1) &
+				       (TFTP_SEQUENCE_SIZE - 1))) {
+			tftp_window_gap();
+			break;
+		}
+
 		update_block_number();
 
 		if (tftp_state == STATE_SEND_RRQ)
@@ -638,7 +711,10 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			}
 		}
 #endif
-		tftp_send();
+		/* Within a window only the last block is acknowledged */
+		if (tftp_windowsize == 1 || tftp_cur_block == tftp_next_ack ||
+		    len < tftp_block_size)
+			tftp_send();
 
 #ifdef CONFIG_MCAST_TFTP
 		if (tftp_mcast_active) {
@@ -710,6 +786,10 @@ void tftp_start(enum proto_t protocol)
 	if (ep != NULL)
 		tftp_block_size_option = simple_strtol(ep, NULL, 10);
 
+	ep = env_get("tftpwindowsize");
+	if (ep != NULL)
+		tftp_windowsize_option = simple_strtol(ep, NULL, 10);
+
 	ep = env_get("tftptimeout");
 	if (ep != NULL)
 		timeout_ms = simple_strtol(ep, NULL, 10);
@@ -731,8 +811,19 @@ void tftp_start(enum proto_t protocol)
 	}
 #endif
 
-	debug("TFTP blocksize = %i, timeout = %ld ms\n",
-	      tftp_block_size_option, timeout_ms);
+#ifndef CONFIG_IP_DEFRAG
+	/* Without reassembly every block has to fit in one frame */
+	if (tftp_block_size_option > TFTP_MTU_BLOCKSIZE_MAX) {
+		printf("TFTP blocksize %d exceeds the MTU, using %d\n",
+		       tftp_block_size_option, TFTP_MTU_BLOCKSIZE_MAX);
+		tftp_block_size_option = TFTP_MTU_BLOCKSIZE_MAX;
+	}
+#endif
+	if (!tftp_windowsize_option)
+		tftp_windowsize_option = 1;
+
+	debug("TFTP blocksize = %i, windowsize = %i, timeout = %ld ms\n",
+	      tftp_block_size_option, tftp_windowsize_option, timeout_ms);
 
 	tftp_remote_ip = net_server_ip;
 	if (net_boot_file_name[0] == '\0') {
@@ -835,8 +926,9 @@ void tftp_start(enum proto_t protocol)
 
 	/* zero out server ether in case the server ip has changed */
 	memset(net_server_ethaddr, 0, 6);
-	/* Revert tftp_block_size to dflt */
+	/* Revert tftp_block_size and tftp_windowsize to dflt */
 	tftp_block_size = TFTP_BLOCK_SIZE;
+	tftp_windowsize = 1;
 #ifdef CONFIG_MCAST_TFTP
 	mcast_cleanup();
 #endif
@@ -864,8 +956,9 @@ void tftp_start_server(void)
 	timeout_ms = TIMEOUT;
 	net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
 
-	/* Revert tftp_block_size to dflt */
+	/* Revert tftp_block_size and tftp_windowsize to dflt */
 	tftp_block_size = TFTP_BLOCK_SIZE;
+	tftp_windowsize = 1;
 	tftp_cur_block = 0;
 	tftp_our_port = WELL_KNOWN_PORT;
 
@@ -960,6 +1053,8 @@ static void parse_multicast_oack(char *pkt, int len)
 		memset(tftp_mcast_bitmap, 0, tftp_mcast_bitmap_size);
 		tftp_mcast_prev_hole = 0;
 		tftp_mcast_active = 1;
+		/* Passive clients cannot drive windows */
+		tftp_windowsize = 1;
 	}
 	addr = string_to_ip(mc_adr);
 	if (net_mcast_addr.s_addr != addr.s_addr) {
@@ -0,0 +1,309 @@
+/*
+ * (C) Copyright 2020 Rockchip Electronics Co., Ltd
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+/*
+ * Checks bmpdecoder() of the Rockchip display driver against the per-pixel
+ * decoder it replaced, on synthetic images of every supported format, and
+ * times both.
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <bmp_layout.h>
+#include <asm/unaligned.h>
+#include "../drivers/video/drm/bmp_helper.h"
+
+#define BMP_WIDTH	639	/* odd: exercises row padding and remainders */
+#define BMP_HEIGHT	480
+#define BMP_LOOPS	10
+
+#define BMP_BI_BITFIELDS	3
+
+#define errcheck(statement) if (!(statement)) { \
+	fprintf(stderr, "\tFailed: %s\n", #statement); \
+	ret = 1; \
+	goto out; \
+}
+
+/* Per-pixel decoder used before the row converters, as the reference */
+static void ref_rle8(uint8_t *bmap, uint8_t *dst, uint16_t *cmap, int width,
+		     int height, bool flip)
+{
+	int linesize = width * 2;
+	uint32_t cnt, runlen, i;
+	int x = 0, y = 0;
+
+	if (flip) {
+		y = height - 1;
+		dst += y * linesize;
+	}
+
+	while (1) {
+		if (bmap[0] == BMP_RLE8_ESCAPE) {
+			switch (bmap[1]) {
+			case BMP_RLE8_EOL:
+				bmap += 2;
+				x = 0;
+				if (flip) {
+					y--;
+					dst -= linesize * 2;
+				} else {
+					y++;
+				}
+				break;
+			case BMP_RLE8_EOBMP:
+				return;
+			case BMP_RLE8_DELTA:
+				x += bmap[2];
+				y += flip ? -bmap[3] : bmap[3];
+				dst += (flip ? -bmap[3] : bmap[3]) * linesize;
+				dst += bmap[2] * 2;
+				bmap += 4;
+				break;
+			default:
+				runlen = bmap[1];
+				bmap += 2;
+				if (y >= height || x >= width)
+					return;
+				cnt = min_t(uint32_t, runlen, width - x);
+				for (i = 0; i < cnt; i++) {
+					*(uint16_t *)dst = cmap[bmap[i]];
+					dst += 2;
+				}
+				x += runlen;
+				bmap += runlen;
+				if (runlen & 1)
+					bmap++;
+			}
+		} else {
+			if (y < height) {
+				runlen = bmap[0];
+				if (x < width) {
+					cnt = min_t(uint32_t, runlen,
+						    width - x);
+					while (cnt--) {
+						*(uint16_t *)dst = cmap[bmap[1]];
+						dst += 2;
+					}
+				}
+				x += runlen;
+			}
+			bmap += 2;
+		}
+	}
+}
+
+static uint16_t ref_pixel16(uint16_t p, bool rgb565)
+{
+	uint16_t r, g, b;
+
+	if (rgb565) {
+		r = p >> 11;
+		g = (p >> 5) & 0x3f;
+	} else {
+		r = (p >> 10) & 0x1f;
+		g = (p >> 5) & 0x1f;
+		g = g << 1 | g >> 4;
+	}
+	b = p & 0x1f;
+
+	return b << 11 | g << 5 | r;
+}
+
+static void ref_decoder(uint8_t *bmp, uint8_t *dst)
+{
+	struct bmp_header *hdr = (struct bmp_header *)bmp;
+	int width = get_unaligned_le32(&hdr->width);
+	int height = get_unaligned_le32(&hdr->height);
+	int bpp = get_unaligned_le16(&hdr->bit_count);
+	uint32_t compression = get_unaligned_le32(&hdr->compression);
+	uint8_t *cmap_base = bmp + sizeof(*hdr);
+	uint8_t *src = bmp + get_unaligned_le32(&hdr->data_offset);
+	int stride = ALIGN(width * bpp / 8, 4);
+	uint16_t cmap[256];
+	bool flip = height > 0;
+	int x, y, line;
+
+	if (!flip)
+		height = -height;
+
+	if (bpp == 8) {
+		for (x = 0; x < 256; x++, cmap_base += 4)
+			cmap[x] = ((cmap_base[0] << 8) & 0xf800) |
+				  ((cmap_base[1] << 3) & 0x07e0) |
+				  ((cmap_base[2] >> 3) & 0x001f);
+		if (compression) {
+			ref_rle8(src, dst, cmap, width, height, flip);
+			return;
+		}
+	}
+
+	for (y = 0; y < height; y++, src += stride) {
+		line = flip ? height - 1 - y : y;
+		for (x = 0; x < width; x++) {
+			uint8_t *out = dst + (line * width + x) * (bpp == 8 ?
+								  2 : bpp / 8);
+
+			switch (bpp) {
+			case 8:
+				*(uint16_t *)out = cmap[src[x]];
+				break;
+			case 16:
+				*(uint16_t *)out = ref_pixel16(
+					get_unaligned_le16(src + x * 2),
+					compression == BMP_BI_BITFIELDS &&
+					get_unaligned_le32(cmap_base) == 0xf800);
+				break;
+			default:
+				memcpy(out, src + x * bpp / 8, bpp / 8);
+			}
+		}
+	}
+}
+
+/* Runs of 1 to 40 pixels, every eighth one a literal run of 5 pixels */
+static int make_rle8(uint8_t *p)
+{
+	uint8_t *start = p;
+	int x, y, n, i, run = 0;
+
+	for (y = 0; y < BMP_HEIGHT; y++) {
+		for (x = 0; x < BMP_WIDTH; x += n, run++) {
+			if (run % 8 == 7 && BMP_WIDTH - x >= 5) {
+				n = 5;
+				*p++ = BMP_RLE8_ESCAPE;
+				*p++ = n;
+				for (i = 0; i < n; i++)
+					*p++ = x * 3 + i + y;
+				*p++ = 0;	/* pad to 16 bits */
+			} else {
+				n = min(1 + (x + y) % 40, BMP_WIDTH - x);
+				*p++ = n;
+				*p++ = x + y * 7;
+			}
+		}
+		*p++ = BMP_RLE8_ESCAPE;
+		*p++ = BMP_RLE8_EOL;
+	}
+	*p++ = BMP_RLE8_ESCAPE;
+	*p++ = BMP_RLE8_EOBMP;
+
+	return p - start;
+}
+
+static uint8_t *make_bmp(int bpp, uint32_t compression, uint32_t mask,
+			 bool top_down)
+{
+	int stride = ALIGN(BMP_WIDTH * bpp / 8, 4);
+	int extra = bpp == 8 ? 256 * 4 : compression ? 12 : 0;
+	int offset = sizeof(struct bmp_header) + extra;
+	int size = offset + stride * BMP_HEIGHT * 2;
+	struct bmp_header *hdr;
+	uint8_t *bmp, *p;
+	int i;
+
+	bmp = calloc(1, size);
+	if (!bmp)
+		return NULL;
+
+	hdr = (struct bmp_header *)bmp;
+	hdr->signature[0] = 'B';
+	hdr->signature[1] = 'M';
+	put_unaligned_le32(offset, &hdr->data_offset);
+	put_unaligned_le32(40, &hdr->size);
+	put_unaligned_le32(BMP_WIDTH, &hdr->width);
+	put_unaligned_le32(top_down ? -BMP_HEIGHT : BMP_HEIGHT, &hdr->height);
+	put_unaligned_le16(1, &hdr->planes);
+	put_unaligned_le16(bpp, &hdr->bit_count);
+	put_unaligned_le32(compression, &hdr->compression);
+
+	p = bmp + sizeof(*hdr);
+	if (bpp == 8) {
+		for (i = 0; i < 256 * 4; i++)
+			p[i] = i * 37 + (i >> 2);
+	} else if (compression) {
+		put_unaligned_le32(mask, p);
+	}
+
+	p = bmp + offset;
+	if (bpp == 8 && compression)
+		size = offset + make_rle8(p);
+	else
+		for (i = 0; i < stride * BMP_HEIGHT; i++)
+			p[i] = i * 131 + (i >> 9);
+	put_unaligned_le32(size, &hdr->file_size);
+
+	return bmp;
+}
+
+static int run_test(const char *name, int bpp, uint32_t compression,
+		    uint32_t mask, bool top_down)
+{
+	int out_bpp = bpp == 8 ? 16 : bpp;
+	int size = BMP_WIDTH * BMP_HEIGHT * out_bpp / 8;
+	uint8_t *bmp, *dst = NULL, *ref = NULL;
+	ulong start, us, ref_us;
+	int i, ret;
+
+	bmp = make_bmp(bpp, compression, mask, top_down);
+	dst = malloc(size);
+	ref = malloc(size);
+	errcheck(bmp && dst && ref);
+	memset(dst, 0xaa, size);
+	memset(ref, 0xaa, size);
+
+	start = timer_get_us();
+	for (i = 0; i < BMP_LOOPS; i++)
+		errcheck(bmpdecoder(bmp, dst, out_bpp) == 0);
+	us = timer_get_us() - start;
+
+	start = timer_get_us();
+	for (i = 0; i < BMP_LOOPS; i++)
+		ref_decoder(bmp, ref);
+	ref_us = timer_get_us() - start;
+
+	errcheck(memcmp(dst, ref, size) == 0);
+	printf(" %-18s %6lu us/frame, per-pixel %6lu us/frame\n", name,
+	       us / BMP_LOOPS, ref_us / BMP_LOOPS);
+	ret = 0;
+
+out:
+	if (ret)
+		printf(" %s: FAILED\n", name);
+	free(ref);
+	free(dst);
+	free(bmp);
+
+	return ret;
+}
+
+static int do_ut_bmp(cmd_tbl_t *cmdtp, int flag, int argc,
+		     char *const argv[])
+{
+	int err = 0;
+
+	printf(" %dx%d, %d loops\n", BMP_WIDTH, BMP_HEIGHT, BMP_LOOPS);
+	err += run_test("8bpp", 8, BMP_BI_RGB, 0, false);
+	err += run_test("8bpp top-down", 8, BMP_BI_RGB, 0, true);
+	err += run_test("8bpp rle8", 8, BMP_BI_RLE8, 0, false);
+	err += run_test("8bpp rle8 top-down", 8, BMP_BI_RLE8, 0, true);
+	err += run_test("16bpp x1r5g5b5", 16, BMP_BI_RGB, 0, false);
+	err += run_test("16bpp r5g6b5", 16, BMP_BI_BITFIELDS, 0xf800, false);
+	err += run_test("24bpp", 24, BMP_BI_RGB, 0, false);
+	err += run_test("24bpp top-down", 24, BMP_BI_RGB, 0, true);
+	err += run_test("32bpp", 32, BMP_BI_RGB, 0, false);
+
+	printf("ut_bmp %s\n", err == 0 ? "ok" : "FAILED");
+
+	return err;
+}
+
+U_BOOT_CMD(
+	ut_bmp,	1,	1,	do_ut_bmp,
+	"Compare the bmp decoder of the Rockchip display with per-pixel decoding",
+	""
+);
@@ -11,6 +11,7 @@
 #include <dm.h>
 #include <fdtdec.h>
 #include <malloc.h>
+#include <mapmem.h>
 #include <net.h>
 #include <dm/test.h>
 #include <dm/device-internal.h>
@@ -259,3 +260,112 @@ static int dm_test_net_retry(struct unit_test_state *uts)
 	return retval;
 }
 DM_TEST(dm_test_net_retry, DM_TESTF_SCAN_FDT);
+
+/* The asserts include a return on fail; cleanup in the caller */
+static int _dm_test_eth_tftp(struct unit_test_state *uts, int window,
+			     int drop_block)
+{
+	const unsigned int size = 100000;
+	/* 1468-byte blocks, the last one short */
+	const int blocks = DIV_ROUND_UP(size + 1, 1468);
+	unsigned int i;
+	uchar *buf;
+
+	sandbox_eth_tftp_file(size, 8, drop_block);
+	env_set_ulong("tftpwindowsize", window);
+
+	buf = map_sysmem(load_addr, size);
+	memset(buf, '\0', size);
+	ut_asserteq(size, net_loop(TFTPGET));
+	for (i = 0; i < size; i++) {
+		if (buf[i] != sandbox_eth_file_data(i))
+			break;
+	}
+	unmap_sysmem(buf);
+	ut_asserteq(size, i);
+
+	/* ACK(0) after the OACK, then one per window */
+	if (!drop_block)
+		ut_asserteq(DIV_ROUND_UP(blocks, window) + 1,
+			    sandbox_eth_tftp_acks());
+
+	return 0;
+}
+
+static int dm_test_eth_tftp(struct unit_test_state *uts)
+{
+	ulong old_load_addr = load_addr;
+	int retval;
+
+	env_set("ethact", "eth@10002000");
+	env_set("serverip", "1.1.2.2");
+	strcpy(net_boot_file_name, "sandbox.img");
+	load_addr = 0x1000000;
+
+	retval = _dm_test_eth_tftp(uts, 1, 0);
+	if (!retval)
+		retval = _dm_test_eth_tftp(uts, 8, 0);
+	/* A lost block in the middle of a window */
+	if (!retval)
+		retval = _dm_test_eth_tftp(uts, 8, 20);
+
+	/* Restore the env */
+	env_set("tftpwindowsize", NULL);
+	sandbox_eth_tftp_file(0, 1, 0);
+	load_addr = old_load_addr;
+
+	return retval;
+}
+DM_TEST(dm_test_eth_tftp, DM_TESTF_SCAN_FDT);
+
+#ifdef CONFIG_CMD_NFS
+/* The asserts include a return on fail; cleanup in the caller */
+static int _dm_test_eth_nfs(struct unit_test_state *uts, bool reorder)
+{
+	const unsigned int size = 100000;
+	unsigned int i;
+	uchar *buf;
+
+	sandbox_eth_nfs_file(size, reorder);
+
+	buf = map_sysmem(load_addr, size);
+	memset(buf, '\0', size);
+	ut_asserteq(size, net_loop(NFS));
+	for (i = 0; i < size; i++) {
+		if (buf[i] != sandbox_eth_file_data(i))
+			break;
+	}
+	unmap_sysmem(buf);
+	ut_asserteq(size, i);
+
+	/* Each block once, plus at most a window of reads past the end */
+	ut_assert(sandbox_eth_nfs_reads() >= DIV_ROUND_UP(size, 1024));
+	ut_assert(sandbox_eth_nfs_reads() <= DIV_ROUND_UP(size, 1024) +
+		  CONFIG_NFS_READ_WINDOW);
+
+	return 0;
+}
+
+static int dm_test_eth_nfs(struct unit_test_state *uts)
+{
+	ulong old_load_addr = load_addr;
+	int retval;
+
+	env_set("ethact", "eth@10002000");
+	env_set("serverip", "1.1.2.2");
+	strcpy(net_boot_file_name, "/export/sandbox.img");
+	load_addr = 0x1000000;
+
+	retval = _dm_test_eth_nfs(uts, false);
+	/* Replies to the pipelined READs arriving out of order */
+	if (!retval)
+		retval = _dm_test_eth_nfs(uts, true);
+
+	/* Restore the env */
+	sandbox_eth_nfs_file(0, false);
+	load_addr = old_load_addr;
+
+	return retval;
+}
+DM_TEST(dm_test_eth_nfs, DM_TESTF_SCAN_FDT);
+#endif
@@ -12,6 +12,7 @@
 #include <os.h>
 #include <video.h>
 #include <video_console.h>
+#include <asm/test.h>
 #include <dm/test.h>
 #include <dm/uclass-internal.h>
 #include <test/ut.h>
@@ -153,6 +154,40 @@ static int dm_test_video_chars(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_chars, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
 
+/* Test that only the lines drawn are recorded for the next sync */
+static int dm_test_video_damage(struct unit_test_state *uts)
+{
+	struct udevice *dev, *con;
+	struct video_priv *priv;
+	int i;
+
+	ut_assertok(select_vidconsole(uts, "vidconsole0"));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	priv = dev_get_uclass_priv(dev);
+
+	/* The whole display was cleared at probe time */
+	ut_asserteq(0, priv->damage_ystart);
+	ut_asserteq(768, priv->damage_yend);
+	video_sync(dev);
+	ut_assert(priv->damage_yend <= priv->damage_ystart);
+
+	vidconsole_put_char(con, '\n');
+	vidconsole_put_char(con, 'a');
+	ut_asserteq(16, priv->damage_ystart);
+	ut_asserteq(32, priv->damage_yend);
+	video_sync(dev);
+
+	/* Scrolling moves the text of the whole display */
+	for (i = 0; i < 48; i++)
+		vidconsole_put_char(con, '\n');
+	ut_asserteq(0, priv->damage_ystart);
+	ut_asserteq(768, priv->damage_yend);
+
+	return 0;
+}
+DM_TEST(dm_test_video_damage, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
 /**
  * check_vidconsole_output() - Run a text console test
  *
@@ -351,3 +386,88 @@ static int dm_test_video_truetype_bs(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_video_truetype_bs, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+#ifdef CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE
+/* Clear the display and go back to the start of the first line */
+static void truetype_restart(struct udevice *dev, struct udevice *con)
+{
+	struct vidconsole_priv *vc_priv = dev_get_uclass_priv(con);
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	u32 *pix = priv->fb;
+	int i;
+
+	for (i = 0; i < priv->fb_size / 4; i++)
+		pix[i] = priv->colour_bg;
+	vc_priv->xcur_frac = vc_priv->xstart_frac;
+	vc_priv->ycur = 0;
+	vc_priv->last_ch = 0;
+}
+
+/*
+ * Test the TrueType glyph cache on a 32bpp display. Cached characters are
+ * placed to the nearest quarter pixel, so no pixel may differ from the
+ * exact rendering by more than the coverage of an eighth of a pixel.
+ */
+static int dm_test_video_truetype_cache(struct unit_test_state *uts)
+{
+	const char *test_string = "The quick brown fox jumps over the lazy dog. 0123456789 {}[]()!?";
+	struct sandbox_sdl_plat *plat;
+	struct video_priv *priv;
+	struct udevice *dev, *con;
+	u32 *exact, *pix;
+	int pass, i, ink;
+	const char *s;
+
+	ut_assertok(uclass_find_device(UCLASS_VIDEO, 0, &dev));
+	ut_assert(!device_active(dev));
+	plat = dev_get_platdata(dev);
+	/* Half the width keeps the size of the 16bpp frame buffer */
+	plat->xres /= 2;
+	plat->bpix = VIDEO_BPP32;
+
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	priv = dev_get_uclass_priv(dev);
+	ut_asserteq(VIDEO_BPP32, priv->bpix);
+
+	/* Without the cache, each character is rendered where it falls */
+	sandbox_console_truetype_set_cache(con, false);
+	truetype_restart(dev, con);
+	for (s = test_string; *s; s++)
+		vidconsole_put_char(con, *s);
+	exact = malloc(priv->fb_size);
+	ut_assertnonnull(exact);
+	memcpy(exact, priv->fb, priv->fb_size);
+
+	/* The first pass fills the cache, the second only uses it */
+	sandbox_console_truetype_set_cache(con, true);
+	for (pass = 0; pass < 2; pass++) {
+		truetype_restart(dev, con);
+		for (s = test_string; *s; s++)
+			vidconsole_put_char(con, *s);
+
+		pix = priv->fb;
+		for (i = ink = 0; i < priv->fb_size / 4; i++) {
+			u32 a = exact[i], b = pix[i];
+			int shift;
+
+			if (b != priv->colour_bg)
+				ink++;
+			/* Blended grey on white keeps equal channels */
+			ut_asserteq(b & 0xff, (b >> 8) & 0xff);
+			ut_asserteq(b & 0xff, (b >> 16) & 0xff);
+			ut_asserteq(priv->colour_bg & 0xff000000, b & 0xff000000);
+			for (shift = 0; shift < 24; shift += 8)
+				ut_assert(abs((int)((a >> shift) & 0xff) -
+					      (int)((b >> shift) & 0xff)) <=
+					  256 / 8);
+		}
+		ut_assert(ink > 1000);
+	}
+	sandbox_console_truetype_set_cache(con, false);
+	free(exact);
+
+	return 0;
+}
+DM_TEST(dm_test_video_truetype_cache, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+#endif
@@ -8,9 +8,11 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <errno.h>
 #include <limits.h>
 #include <regex.h>
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -19,6 +21,7 @@
 #include <sys/types.h>
 
 #include <compiler.h>
+#include <bootstage.h>
 #include <trace.h>
 
 #define MAX_LINE_LEN 500
@@ -59,6 +62,21 @@ int call_count;
 int verbose;	/* Verbosity level 0=none, 1=warn, 2=notice, 3=info, 4=debug */
 unsigned long text_offset;		/* text address of first function */
 
+/* Bootstage stash, see bootstage_stash() */
+struct bootstage_hdr *bs_hdr;
+struct bootstage_stash_record *bs_rec;
+struct bootstage_stash_span *bs_span;
+const char **bs_rec_name;
+const char **bs_span_name;
+
+static const char *const span_cat_name[BOOTSTAGE_SPAN_CAT_COUNT] = {
+	[BOOTSTAGE_SPAN_PROBE]		= "probe",
+	[BOOTSTAGE_SPAN_BLK_READ]	= "blk_read",
+	[BOOTSTAGE_SPAN_BLK_WRITE]	= "blk_write",
+	[BOOTSTAGE_SPAN_DECOMP]		= "decomp",
+	[BOOTSTAGE_SPAN_HASH]		= "hash",
+};
+
 static void outf(int level, const char *fmt, ...)
 		__attribute__ ((format (__printf__, 2, 3)));
 #define error(fmt, b...) outf(0, fmt, ##b)
@@ -86,8 +104,10 @@ static void usage(void)
 		"\n"
 		"Commands\n"
 		"   dump-ftrace\t\tDump out textual data in ftrace format\n"
+		"   dump-chrome\t\tDump bootstage and trace data in Chrome trace-event JSON\n"
 		"\n"
 		"Options:\n"
+		"   -b <stash>\tSpecify bootstage stash file (from U-Boot)\n"
 		"   -m <map>\tSpecify Systen.map file\n"
 		"   -t <trace>\tSpecific trace data file (from U-Boot)\n"
 		"   -v <0-4>\tSpecify verbosity\n");
@@ -298,6 +318,71 @@ static int read_profile_file(const char *fname)
 	return 0;
 }
 
+static int read_bootstage_file(const char *fname)
+{
+	struct bootstage_hdr *hdr;
+	const char *ptr, *end;
+	FILE *fin;
+	long size;
+	int i;
+
+	fin = fopen(fname, "rb");
+	if (!fin) {
+		error("Cannot open bootstage file '%s'\n", fname);
+		return 1;
+	}
+	fseek(fin, 0, SEEK_END);
+	size = ftell(fin);
+	fseek(fin, 0, SEEK_SET);
+	hdr = malloc(size > 0 ? size : 1);
+	assert(hdr);
+	if (size < (long)sizeof(*hdr) || read_data(fin, hdr, size)) {
+		error("Cannot read bootstage file '%s'\n", fname);
+		fclose(fin);
+		return 1;
+	}
+	fclose(fin);
+
+	if (hdr->magic != BOOTSTAGE_MAGIC ||
+	    hdr->version != BOOTSTAGE_VERSION || hdr->size > size ||
+	    sizeof(*hdr) + (unsigned long)hdr->count * sizeof(*bs_rec) +
+	    (unsigned long)hdr->span_count * sizeof(*bs_span) > hdr->size) {
+		error("Bootstage file '%s' is not a valid version %d stash\n",
+		      fname, BOOTSTAGE_VERSION);
+		return 1;
+	}
+
+	bs_hdr = hdr;
+	bs_rec = (struct bootstage_stash_record *)(hdr + 1);
+	bs_span = (struct bootstage_stash_span *)(bs_rec + hdr->count);
+	bs_rec_name = calloc(hdr->count + 1, sizeof(char *));
+	bs_span_name = calloc(hdr->span_count + 1, sizeof(char *));
+	assert(bs_rec_name && bs_span_name);
+
+	/* Record names, then span names */
+	ptr = (const char *)(bs_span + hdr->span_count);
+	end = (const char *)hdr + hdr->size;
+	for (i = 0; i < hdr->count + hdr->span_count; i++) {
+		const char *name = ptr;
+
+		ptr = memchr(ptr, '\0', end - ptr);
+		if (!ptr) {
+			error("Bootstage file '%s': names are truncated\n",
+			      fname);
+			return 1;
+		}
+		ptr++;
+		if (i < hdr->count)
+			bs_rec_name[i] = name;
+		else
+			bs_span_name[i - hdr->count] = name;
+	}
+	notice("bootstage: %u records, %u spans (%u dropped)\n", hdr->count,
+	       hdr->span_count, hdr->span_dropped);
+
+	return 0;
+}
+
 static int regex_report_error(regex_t *regex, int err, const char *op,
 			      const char *name)
 {
@@ -533,13 +618,131 @@ static int make_ftrace(void)
 	return 0;
 }
 
+static void json_string(const char *str)
+{
+	putchar('"');
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\')
+			printf("\\%c", *str);
+		else if ((unsigned char)*str < ' ')
+			printf("\\u%04x", *str);
+		else
+			putchar(*str);
+	}
+	putchar('"');
+}
+
+/* Start a trace event, with the separator from the previous one */
+static void json_event(int *count, const char *ph, int tid, const char *name)
+{
+	printf("%s{\"ph\":\"%s\",\"pid\":1,\"tid\":%d,\"name\":",
+	       (*count)++ ? ",\n" : "", ph, tid);
+	json_string(name);
+}
+
+enum {
+	CHROME_TID_BOOTSTAGE	= 0,
+	CHROME_TID_SPAN		= 1,	/* + enum bootstage_span_cat */
+	CHROME_TID_FUNC		= CHROME_TID_SPAN + BOOTSTAGE_SPAN_CAT_COUNT,
+};
+
+/*
+ * Write one timeline in the Chrome trace-event format, which
+ * chrome://tracing and https://ui.perfetto.dev show as a flame chart:
+ * bootstage marks as instant events, profile spans as complete events
+ * with one row per category, and traced function calls as begin/end
+ * events. Accumulated bootstage times have no place on the timeline and
+ * go to otherData.
+ */
+static int make_chrome(void)
+{
+	int count = 0, first;
+	int i;
+
+	printf("{\"traceEvents\":[\n");
+	json_event(&count, "M", CHROME_TID_BOOTSTAGE, "thread_name");
+	printf(",\"args\":{\"name\":\"bootstage\"}}");
+	for (i = 0; i < BOOTSTAGE_SPAN_CAT_COUNT; i++) {
+		json_event(&count, "M", CHROME_TID_SPAN + i, "thread_name");
+		printf(",\"args\":{\"name\":\"%s\"}}", span_cat_name[i]);
+	}
+	if (call_count) {
+		json_event(&count, "M", CHROME_TID_FUNC, "thread_name");
+		printf(",\"args\":{\"name\":\"functions\"}}");
+	}
+
+	for (i = 0; bs_hdr && i < bs_hdr->count; i++) {
+		struct bootstage_stash_record *rec = &bs_rec[i];
+
+		if (rec->start_us)
+			continue;
+		json_event(&count, "i", CHROME_TID_BOOTSTAGE, bs_rec_name[i]);
+		printf(",\"cat\":\"bootstage\",\"s\":\"g\",\"ts\":%u%s}",
+		       rec->time_us,
+		       rec->flags & BOOTSTAGEF_ERROR ?
+		       ",\"args\":{\"error\":1}" : "");
+	}
+
+	for (i = 0; bs_hdr && i < bs_hdr->span_count; i++) {
+		struct bootstage_stash_span *span = &bs_span[i];
+		const char *cat = span->cat < BOOTSTAGE_SPAN_CAT_COUNT ?
+				  span_cat_name[span->cat] : "unknown";
+
+		json_event(&count, "X", CHROME_TID_SPAN +
+			   (span->cat % BOOTSTAGE_SPAN_CAT_COUNT),
+			   bs_span_name[i]);
+		printf(",\"cat\":\"%s\",\"ts\":%u,\"dur\":%u", cat,
+		       span->start_us, span->end_us - span->start_us);
+		printf(",\"args\":{\"bytes\":%u,\"ops\":%u,\"busy_us\":%u}}",
+		       span->bytes, span->count, span->busy_us);
+	}
+
+	for (i = 0; i < call_count; i++) {
+		struct trace_call *call = &call_list[i];
+		struct func_info *func = find_func_by_offset(call->func);
+		ulong time = call->flags & FUNCF_TIMESTAMP_MASK;
+
+		if (TRACE_CALL_TYPE(call) != FUNCF_ENTRY &&
+		    TRACE_CALL_TYPE(call) != FUNCF_EXIT)
+			continue;
+		if (!func || !(func->flags & FUNCF_TRACE))
+			continue;
+		json_event(&count,
+			   TRACE_CALL_TYPE(call) == FUNCF_ENTRY ? "B" : "E",
+			   CHROME_TID_FUNC, func->name);
+		printf(",\"ts\":%lu}", time);
+	}
+
+	printf("\n],\"displayTimeUnit\":\"ms\",\"otherData\":{");
+	first = 1;
+	for (i = 0; bs_hdr && i < bs_hdr->count; i++) {
+		if (!bs_rec[i].start_us)
+			continue;
+		printf("%s", first ? "" : ",");
+		json_string(bs_rec_name[i]);
+		printf(":\"%u us\"", bs_rec[i].time_us);
+		first = 0;
+	}
+	if (bs_hdr && bs_hdr->span_dropped)
+		printf("%s\"spans_dropped\":\"%u\"", first ? "" : ",",
+		       bs_hdr->span_dropped);
+	printf("}}\n");
+	info("chrome: %d events\n", count);
+
+	return 0;
+}
+
 static int prof_tool(int argc, char * const argv[],
 		     const char *prof_fname, const char *map_fname,
-		     const char *trace_config_fname)
+		     const char *trace_config_fname,
+		     const char *bootstage_fname)
 {
 	int err = 0;
 
-	if (read_map_file(map_fname))
+	/* The map is only needed to decode trace data */
+	if ((prof_fname || !bootstage_fname) && read_map_file(map_fname))
+		return -1;
+	if (bootstage_fname && read_bootstage_file(bootstage_fname))
 		return -1;
 	if (prof_fname && read_profile_file(prof_fname))
 		return -1;
@@ -553,6 +756,8 @@ static int prof_tool(int argc, char * const argv[],
 
 		if (0 == strcmp(cmd, "dump-ftrace"))
 			err = make_ftrace();
+		else if (0 == strcmp(cmd, "dump-chrome"))
+			err = make_chrome();
 		else
 			warn("Unknown command '%s'\n", cmd);
 	}
@@ -565,11 +770,16 @@ int main(int argc, char *argv[])
 	const char *map_fname = "System.map";
 	const char *prof_fname = NULL;
 	const char *trace_config_fname = NULL;
+	const char *bootstage_fname = NULL;
 	int opt;
 
 	verbose = 2;
-	while ((opt = getopt(argc, argv, "m:p:t:v:")) != -1) {
+	while ((opt = getopt(argc, argv, "b:m:p:t:v:")) != -1) {
 		switch (opt) {
+		case 'b':
+			bootstage_fname = optarg;
+			break;
+
 		case 'm':
 			map_fname = optarg;
 			break;
@@ -596,5 +806,5 @@ int main(int argc, char *argv[])
 
 	debug("Debug enabled\n");
 	return prof_tool(argc, argv, prof_fname, map_fname,
-			 trace_config_fname);
+			 trace_config_fname, bootstage_fname);
 }